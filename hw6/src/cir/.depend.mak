@@ -1,7 +1,23 @@
-cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h cirGate.h cirCmd.h \
-  ../../include/cmdParser.h ../../include/cmdCharDef.h \
+cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+ cirCmd.h ../../include/cmdParser.h ../../include/cmdCharDef.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirEdit.o: cirEdit.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirFraig.o: cirFraig.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/sat.h ../../include/util.h ../../include/rnGen.h \
+  ../../include/myUsage.h
+cirGate.o: cirGate.cpp cirGate.h cirDef.h cirMem.h cirOut.h cirMgr.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirMap.o: cirMap.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirOpt.o: cirOpt.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirRewrite.o: cirRewrite.cpp cirMgr.h cirDef.h cirGate.h cirMem.h \
+ cirOut.h ../../include/util.h ../../include/rnGen.h \
+  ../../include/myUsage.h
+cirSim.o: cirSim.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
+  ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
+cirSnap.o: cirSnap.cpp cirMgr.h cirDef.h cirGate.h cirMem.h cirOut.h \
   ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
-cirGate.o: cirGate.cpp cirGate.h cirDef.h cirMgr.h ../../include/util.h \
-  ../../include/rnGen.h ../../include/myUsage.h
-cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
-  ../../include/rnGen.h ../../include/myUsage.h
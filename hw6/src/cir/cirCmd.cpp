@@ -24,7 +24,16 @@ initCirCmd()
    if (!(cmdMgr->regCmd("CIRRead", 4, new CirReadCmd) &&
          cmdMgr->regCmd("CIRPrint", 4, new CirPrintCmd) &&
          cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd) &&
+         cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
+         cmdMgr->regCmd("CIRSWeep", 5, new CirSweepCmd) &&
+         cmdMgr->regCmd("CIROPTimize", 6, new CirOptCmd) &&
+         cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
+         cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
+         cmdMgr->regCmd("CIRREWrite", 6, new CirRewriteCmd) &&
+         cmdMgr->regCmd("CIRMap", 4, new CirMapCmd) &&
+         cmdMgr->regCmd("CIREDit", 5, new CirEditCmd) &&
+         cmdMgr->regCmd("CIRSTAt", 6, new CirStatCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -44,7 +53,7 @@ enum CirCmdState
 static CirCmdState curCmd = CIRINIT;
 
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Replace] [-Threads (int n) | -Snapshot]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirReadCmd::exec(const string& option)
@@ -56,19 +65,36 @@ CirReadCmd::exec(const string& option)
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
-   bool doReplace = false;
+   bool doReplace = false, doSnapshot = false;
+   int nThreads = 0;
    string fileName;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Snapshot", options[i], 2) == 0) {
+         if (doSnapshot)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doSnapshot = true;
+      }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (nThreads)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nThreads) || nThreads <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          fileName = options[i];
       }
    }
+   // a snapshot is loaded without parsing; there is nothing to split
+   if (doSnapshot && nThreads)
+      return CmdExec::errorOption(CMD_OPT_EXTRA, "-Threads");
 
    if (cirMgr != 0) {
       if (doReplace) {
@@ -83,7 +109,9 @@ CirReadCmd::exec(const string& option)
    }
    cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
+   bool ok = doSnapshot? cirMgr->readSnapshot(fileName):
+                         cirMgr->readCircuit(fileName, nThreads);
+   if (!ok) {
       curCmd = CIRINIT;
       delete cirMgr; cirMgr = 0;
       return CMD_EXEC_ERROR;
@@ -97,7 +125,8 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Replace] "
+      << "[-Threads (int n) | -Snapshot]" << endl;
 }
 
 void
@@ -132,10 +161,8 @@ CirPrintCmd::exec(const string& option)
       cirMgr->printPOs();
    else if (myStrNCmp("-FLoating", token, 3) == 0)
       cirMgr->printFloatGates();
-/*
    else if (myStrNCmp("-FECpairs", token, 4) == 0)
       cirMgr->printFECPairs();
-*/
    else
       return CmdExec::errorOption(CMD_OPT_ILLEGAL, token);
 
@@ -145,10 +172,8 @@ CirPrintCmd::exec(const string& option)
 void
 CirPrintCmd::usage(ostream& os) const
 {  
-   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating]"
-      << endl;
-//   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating "
-//      << "| -FECpairs]" << endl;
+   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating "
+      << "| -FECpairs]" << endl;
 }
 
 void
@@ -158,7 +183,7 @@ CirPrintCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRGate <<(int gateId)> [<-FANIn | -FANOut><(int level)>]>
+//    CIRGate <<(int gateId)> [<-FANIn | -FANOut><(int level)>] | -All>
 //----------------------------------------------------------------------
 CmdExecStatus
 CirGateCmd::exec(const string& option)
@@ -175,6 +200,12 @@ CirGateCmd::exec(const string& option)
 
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (myStrNCmp("-All", options[0], 2) == 0) {
+      if (options.size() > 1)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[1]);
+      cirMgr->reportAllGates();
+      return CMD_EXEC_DONE;
+   }
 
    int gateId = -1, level = 0;
    bool doFanin = false, doFanout = false;
@@ -233,8 +264,8 @@ CirGateCmd::exec(const string& option)
 void
 CirGateCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRGate <<(int gateId)> [<-FANIn | -FANOut><(int level)>]>"
-      << endl;
+   os << "Usage: CIRGate <<(int gateId)> [<-FANIn | -FANOut><(int level)>] "
+      << "| -All>" << endl;
 }
 
 void
@@ -245,7 +276,7 @@ CirGateCmd::help() const
 
 
 //----------------------------------------------------------------------
-//    CIRWrite [-Output (string aagFile)]
+//    CIRWrite [-Binary | -Snapshot] [-Output (string aagFile)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
@@ -258,19 +289,48 @@ CirWriteCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (options.empty())
-      cirMgr->writeAag(cout);
-   else if (myStrNCmp("-Output", options[0], 2) == 0) {
-      if (options.size() == 1)
-         return CmdExec::errorOption(CMD_OPT_MISSING, options[0]);
-      if (options.size() > 2)
-         return CmdExec::errorOption(CMD_OPT_EXTRA, options[2]);
-      ofstream outfile(options[1].c_str(), ios::out);
+   bool doBinary = false, doSnapshot = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary || doSnapshot)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBinary = true;
+      }
+      else if (myStrNCmp("-Snapshot", options[i], 2) == 0) {
+         if (doBinary || doSnapshot)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doSnapshot = true;
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         fileName = options[i];
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (doSnapshot && fileName.empty()) {
+      cerr << "Error: a snapshot can only be written to a file (-Output)!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+
+   if (fileName.empty()) {
+      if (doBinary) cirMgr->writeAig(cout);
+      else cirMgr->writeAag(cout);
+   }
+   else {
+      ofstream outfile(fileName.c_str(), doBinary || doSnapshot?
+                       ios::out | ios::binary: ios::out);
       if (!outfile)
-         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
-      cirMgr->writeAag(outfile);
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      if (doSnapshot) cirMgr->writeSnapshot(outfile);
+      else if (doBinary) cirMgr->writeAig(outfile);
+      else cirMgr->writeAag(outfile);
    }
-   else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
 
    return CMD_EXEC_DONE;
 }
@@ -278,13 +338,448 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [-Binary | -Snapshot] [-Output (string aagFile)]"
+      << endl;
 }
 
 void
 CirWriteCmd::help() const
 {
    cout << setw(15) << left << "CIRWrite: "
-        << "write the netlist to an ASCII AIG file (.aag)\n";
+        << "write the netlist to an AIG file (.aag, .aig) or a snapshot\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSIMulate <-Random | -File <string patternFile> | -Bench>
+//                [-Threads (int n)] [-Output (string logFile)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSimCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+   ifstream patternFile;
+   ofstream logFile;
+   bool doRandom = false, doFile = false, doBench = false, doLog = false;
+   int nThreads = 0;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Random", options[i], 2) == 0) {
+         if (doRandom || doFile || doBench)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doRandom = true;
+      }
+      else if (myStrNCmp("-Bench", options[i], 2) == 0) {
+         if (doRandom || doFile || doBench)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBench = true;
+      }
+      else if (myStrNCmp("-File", options[i], 2) == 0) {
+         if (doRandom || doFile || doBench)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         patternFile.open(options[i].c_str(), ios::in);
+         if (!patternFile)
+            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
+         doFile = true;
+      }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (nThreads)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nThreads) || nThreads <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (doLog)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         logFile.open(options[i].c_str(), ios::out);
+         if (!logFile)
+            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
+         doLog = true;
+      }
+      else
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (!doRandom && !doFile && !doBench)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   cirMgr->setSimThreads(nThreads);
+   if (doLog)
+      cirMgr->setSimLog(&logFile);
+   else cirMgr->setSimLog(0);
+
+   if (doRandom)
+      cirMgr->randomSim();
+   else if (doBench)
+      cirMgr->benchSim();
+   else
+      cirMgr->fileSim(patternFile);
+   cirMgr->setSimLog(0);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSimCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSIMulate <-Random | -File <string patternFile> | -Bench>\n"
+      << "                   [-Threads (int n)] [-Output (string logFile)]"
+      << endl;
+}
+
+void
+CirSimCmd::help() const
+{
+   cout << setw(15) << left << "CIRSIMulate: "
+        << "perform Boolean logic simulation on the circuit\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSWeep
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSweepCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->sweep();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSweepCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSWeep" << endl;
+}
+
+void
+CirSweepCmd::help() const
+{
+   cout << setw(15) << left << "CIRSWeep: "
+        << "remove unused gates\n";
+}
+
+//----------------------------------------------------------------------
+//    CIROPTimize
+//----------------------------------------------------------------------
+CmdExecStatus
+CirOptCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->optimize();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirOptCmd::usage(ostream& os) const
+{
+   os << "Usage: CIROPTimize" << endl;
 }
 
+void
+CirOptCmd::help() const
+{
+   cout << setw(15) << left << "CIROPTimize: "
+        << "perform trivial optimizations\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSTRash
+//----------------------------------------------------------------------
+CmdExecStatus
+CirStrashCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->strash();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirStrashCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSTRash" << endl;
+}
+
+void
+CirStrashCmd::help() const
+{
+   cout << setw(15) << left << "CIRSTRash: "
+        << "perform structural hash on the circuit netlist\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRFraig
+//----------------------------------------------------------------------
+CmdExecStatus
+CirFraigCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->fraig();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirFraigCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRFraig" << endl;
+}
+
+void
+CirFraigCmd::help() const
+{
+   cout << setw(15) << left << "CIRFraig: "
+        << "perform Boolean logic simplification on the circuit\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRREWrite
+//----------------------------------------------------------------------
+CmdExecStatus
+CirRewriteCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->rewrite();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirRewriteCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRREWrite" << endl;
+}
+
+void
+CirRewriteCmd::help() const
+{
+   cout << setw(15) << left << "CIRREWrite: "
+        << "replace 4-input cuts by smaller subgraphs\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRMap [-K (int k)] [-Output (string blifFile)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirMapCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+
+   int k = 0;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-K", options[i], 2) == 0) {
+         if (k) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], k) || k < 2 || k > 6)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         fileName = options[i];
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (!k) k = 6;
+
+   if (fileName.empty())
+      cirMgr->lutMap(k, 0, "");
+   else {
+      ofstream outfile(fileName.c_str(), ios::out);
+      if (!outfile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      // the model is named after the file
+      size_t b = fileName.find_last_of('/');
+      string model = fileName.substr(b == string::npos? 0: b + 1);
+      model = model.substr(0, model.find('.'));
+      cirMgr->lutMap(k, &outfile, model.empty()? "top": model);
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirMapCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRMap [-K (int k)] [-Output (string blifFile)]" << endl;
+}
+
+void
+CirMapCmd::help() const
+{
+   cout << setw(15) << left << "CIRMap: "
+        << "map the circuit to k-input LUTs (k = 2..6, default 6)\n";
+}
+
+//----------------------------------------------------------------------
+//    CIREDit <-Random (int nEdits)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirEditCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (myStrNCmp("-Random", options[0], 2) != 0)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
+   if (options.size() == 1)
+      return CmdExec::errorOption(CMD_OPT_MISSING, options[0]);
+   int nEdits;
+   if (!myStr2Int(options[1], nEdits) || nEdits <= 0)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[1]);
+   if (options.size() > 2)
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[2]);
+
+   cirMgr->benchEdit(nEdits);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirEditCmd::usage(ostream& os) const
+{
+   os << "Usage: CIREDit <-Random (int nEdits)>" << endl;
+}
+
+void
+CirEditCmd::help() const
+{
+   cout << setw(15) << left << "CIREDit: "
+        << "benchmark incremental edits with random AND rotations\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSTAt <-Profile> [-Output (string jsonFile)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirStatCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+
+   bool doProfile = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Profile", options[i], 2) == 0) {
+         if (doProfile)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doProfile = true;
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         fileName = options[i];
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (!doProfile)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   if (fileName.empty()) cirMgr->printProfile();
+   else {
+      ofstream outfile(fileName.c_str());
+      if (!outfile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      cirMgr->writeProfile(outfile);
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirStatCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSTAt <-Profile> [-Output (string jsonFile)]" << endl;
+}
+
+void
+CirStatCmd::help() const
+{
+   cout << setw(15) << left << "CIRSTAt: "
+        << "report the time and heap allocations of each phase\n";
+}
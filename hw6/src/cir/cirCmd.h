@@ -15,5 +15,14 @@ CmdClass(CirReadCmd);
 CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirSimCmd);
+CmdClass(CirSweepCmd);
+CmdClass(CirOptCmd);
+CmdClass(CirStrashCmd);
+CmdClass(CirFraigCmd);
+CmdClass(CirRewriteCmd);
+CmdClass(CirMapCmd);
+CmdClass(CirEditCmd);
+CmdClass(CirStatCmd);
 
 #endif // CIR_CMD_H
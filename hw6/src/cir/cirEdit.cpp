@@ -0,0 +1,332 @@
+/****************************************************************************
+  FileName     [ cirEdit.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir incremental editing functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <queue>
+#include <functional>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// Tries to find a gate to rotate before CIREDit -Random gives up
+#define EDIT_MAX_TRIES   1000
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Fanout arrays of edited gates come from _mem and hold a power of 2 (at
+// least 2) of entries, so an array holding n entries has room for at least
+// foCapacity(n). Arrays still in _fanoutPool are exactly full.
+static inline unsigned
+foCapacity(unsigned n)
+{
+   unsigned c = 2;
+   while (c < n) c <<= 1;
+   return c;
+}
+
+static inline unsigned
+randomIndex(unsigned n)
+{
+   unsigned r = rnGen(n);
+   return r < n? r: n - 1;
+}
+
+/******************************************/
+/*   Public member functions about edit   */
+/******************************************/
+// Apply random rotations AND(a, AND(b, c)) -> AND(AND(a, b), c), each as
+// four edits: insert AND(a, b), replace both fanins of the root, delete
+// the old inner gate. The circuit function does not change, but the
+// levels do, both ways. The incremental cost is compared with rebuilding
+// the DFS list and levels after every edit, and the levels kept by the
+// edits are checked against a rebuild at the end.
+void
+CirMgr::benchEdit(unsigned nEdits)
+{
+   unsigned depthBefore = _depth;
+   beginEdits();
+   _nLevelUpdates = _nCycleVisits = 0;
+   unsigned nDone = 0, nRotations = 0;
+   double start = getWallTime();
+   while (nDone < nEdits) {
+      CirGate* g = 0;
+      unsigned j = 0;
+      for (unsigned t = 0; t < EDIT_MAX_TRIES && !g; t++) {
+         CirGate* h = _Gatelist[randomIndex(_Gatelist.size())];
+         if (!h || h->_type != AIG_GATE) continue;
+         unsigned first = randomIndex(2);
+         for (unsigned k = 0; k < 2 && !g; k++) {
+            const CirGateV& x = h->_fanin[first ^ k];
+            if (x->_type == AIG_GATE && !x.isInv() && x->_foNum == 1 &&
+                x.gate() != h->_fanin[first ^ k ^ 1].gate()) {
+               g = h;
+               j = first ^ k;
+            }
+         }
+      }
+      if (!g) break;
+      CirGate* x = g->_fanin[j].gate();
+      unsigned s = randomIndex(2);
+      CirGateV a = g->_fanin[j ^ 1], b = x->_fanin[s], c = x->_fanin[s ^ 1];
+      CirGate* y = addAig(a, b);
+      bool ok = setFanin(g, j, CirGateV(y)) && setFanin(g, j ^ 1, c);
+      assert(ok);
+      removeAig(x);
+      nDone += 4;
+      ++nRotations;
+   }
+   double incTime = getWallTime() - start;
+
+   // the levels from scratch
+   unsigned nWrong = 0;
+   GateList order;
+   dfsOrder(_out, order);
+   IdList level(_Gatelist.size(), 0);
+   for (size_t i = 0; i < order.size(); i++) {
+      const CirGate* g = order[i];
+      unsigned lv = 0;
+      for (unsigned k = 0; k < g->getFaninNum(); k++)
+         lv = max(lv, level[g->_fanin[k]->_id] + 1);
+      level[g->_id] = lv;
+      if (lv != g->_level) ++nWrong;
+   }
+
+   // a full rebuild per edit, timed on a sample
+   unsigned nFull = min(nDone, 1000u);
+   start = getWallTime();
+   for (unsigned i = 0; i < nFull; i++) DFS();
+   double fullTime = nFull? (getWallTime() - start) / nFull: 0;
+   commitEdits();
+
+   cout << "Editing: " << nDone << " edit(s) (" << nRotations
+        << " rotation(s)) in " << setprecision(4) << incTime << " seconds, "
+        << setprecision(4) << (nDone? incTime / nDone * 1e6: 0)
+        << " us per edit." << endl
+        << "  " << _nLevelUpdates << " level update(s), " << _nCycleVisits
+        << " gate(s) visited by cycle checks; depth " << depthBefore
+        << " -> " << _depth << "; levels "
+        << (nWrong? "WRONG": "verified") << endl
+        << "  full rebuild: " << setprecision(4) << fullTime * 1e6
+        << " us per edit (" << setprecision(4)
+        << (incTime > 0? fullTime * nDone / incTime: 0) << "x)" << endl;
+}
+
+/*******************************************/
+/*   Private member functions about edit   */
+/*******************************************/
+// Levels are only kept for the gates in _dfsList; give every gate one.
+// A gate without fanouts gets no fanout array, so that a non-null array
+// outside _fanoutPool is always one from _mem.
+void
+CirMgr::beginEdits()
+{
+   for (size_t i = 0; i < _Gatelist.size(); i++)
+      if (_Gatelist[i] && !_Gatelist[i]->_foNum) _Gatelist[i]->_fanout = 0;
+   GateList roots(_out);
+   roots.insert(roots.end(), _aig.begin(), _aig.end());
+   GateList order;
+   dfsOrder(roots, order);
+   for (size_t i = 0; i < order.size(); i++) {
+      CirGate* g = order[i];
+      unsigned lv = 0;
+      for (unsigned j = 0; j < g->getFaninNum(); j++)
+         lv = max(lv, g->_fanin[j]->_level + 1);
+      g->_level = lv;
+   }
+}
+
+// Rebuild what the edits left stale. New gates got IDs past the POs; they
+// are moved to the IDs of removed gates, and if there are not enough, M
+// grows and the POs move up.
+void
+CirMgr::commitEdits()
+{
+   for (size_t i = 0; i < _Gatelist.size(); i++) {
+      CirGate* g = _Gatelist[i];
+      if (g && g->_fanout && !inFanoutPool(g))
+         _mem.free(g->_fanout, foCapacity(g->_foNum) * sizeof(CirGateV));
+   }
+   size_t n = 0;
+   for (size_t i = 0; i < _aig.size(); i++)
+      if (_Gatelist[_aig[i]->_id] == _aig[i]) _aig[n++] = _aig[i];
+   _aig.resize(n);
+   for (size_t i = 0; i < _editAdded.size(); i++)
+      if (_Gatelist[_editAdded[i]->_id] == _editAdded[i])
+         _aig.push_back(_editAdded[i]);
+   for (size_t i = 0; i < _editRemoved.size(); i++)
+      _mem.free(_editRemoved[i], sizeof(CirAigGate));
+
+   IdList holes;
+   for (unsigned id = 1; id <= M; id++)
+      if (!_Gatelist[id]) holes.push_back(id);
+   GateList added;
+   for (size_t id = M + O + 1; id < _Gatelist.size(); id++)
+      if (_Gatelist[id]) added.push_back(_Gatelist[id]);
+   unsigned newM = M + (added.size() > holes.size()?
+                        added.size() - holes.size(): 0);
+   GateList list(newM + O + 1, 0);
+   for (unsigned id = 0; id <= M; id++) list[id] = _Gatelist[id];
+   for (size_t i = 0; i < added.size(); i++) {
+      unsigned id = i < holes.size()? holes[i]: M + 1 + (i - holes.size());
+      added[i]->_id = id;
+      list[id] = added[i];
+   }
+   for (unsigned i = 0; i < O; i++) {
+      _out[i]->_id = newM + 1 + i;
+      list[newM + 1 + i] = _out[i];
+   }
+   _Gatelist.swap(list);
+   M = newM;
+   A = _aig.size();
+   _editAdded.clear();
+   _editRemoved.clear();
+   buildFanout();
+   DFS();
+   clearFecGrps();
+}
+
+// A new AIG of "in0" and "in1", with no fanouts
+CirGate*
+CirMgr::addAig(const CirGateV& in0, const CirGateV& in1)
+{
+   CirGate* g = new (_mem) CirAigGate(_Gatelist.size(), 0);
+   _Gatelist.push_back(g);
+   _editAdded.push_back(g);
+   g->_fanin[0] = in0;
+   g->_fanin[1] = in1;
+   addFanout(in0.gate(), CirGateV(g, in0.isInv()));
+   addFanout(in1.gate(), CirGateV(g, in1.isInv()));
+   g->_level = max(in0->_level, in1->_level) + 1;
+   return g;
+}
+
+// Make "in" fanin "i" of AIG/PO "g"; false (and nothing changes) if "in"
+// depends on "g"
+bool
+CirMgr::setFanin(CirGate* g, unsigned i, const CirGateV& in)
+{
+   const CirGateV& old = g->_fanin[i];
+   if (old == in) return true;
+   if (reaches(g, in.gate())) return false;
+   removeFanout(old.gate(), CirGateV(g, old.isInv()));
+   g->_fanin[i] = in;
+   addFanout(in.gate(), CirGateV(g, in.isInv()));
+   updateLevels(g);
+   return true;
+}
+
+// Delete AIG "g", which must have no fanouts
+void
+CirMgr::removeAig(CirGate* g)
+{
+   assert(g->_type == AIG_GATE && !g->_foNum);
+   for (unsigned j = 0; j < 2; j++)
+      removeFanout(g->_fanin[j].gate(), CirGateV(g, g->_fanin[j].isInv()));
+   _Gatelist[g->_id] = 0;
+   _editRemoved.push_back(g);
+}
+
+void
+CirMgr::addFanout(CirGate* in, const CirGateV& out)
+{
+   bool inPool = inFanoutPool(in);
+   unsigned n = in->_foNum;
+   if (!in->_fanout || inPool || n == foCapacity(n)) {
+      CirGateV* fo = (CirGateV*)_mem.alloc(foCapacity(n + 1) * sizeof(CirGateV));
+      for (unsigned k = 0; k < n; k++) fo[k] = in->_fanout[k];
+      if (in->_fanout && !inPool)
+         _mem.free(in->_fanout, foCapacity(n) * sizeof(CirGateV));
+      in->_fanout = fo;
+   }
+   in->_fanout[in->_foNum++] = out;
+}
+
+// Remove one "out" from the fanouts of "in", keeping the order
+void
+CirMgr::removeFanout(CirGate* in, const CirGateV& out)
+{
+   unsigned k = 0;
+   while (in->_fanout[k] != out) ++k;
+   for (--in->_foNum; k < in->_foNum; k++) in->_fanout[k] = in->_fanout[k+1];
+   if (!in->_foNum && !inFanoutPool(in)) {
+      _mem.free(in->_fanout, foCapacity(1) * sizeof(CirGateV));
+      in->_fanout = 0;
+   }
+}
+
+bool
+CirMgr::inFanoutPool(const CirGate* g) const
+{
+   return !_fanoutPool.empty() && g->_fanout >= &_fanoutPool[0] &&
+          g->_fanout < &_fanoutPool[0] + _fanoutPool.size();
+}
+
+// Whether "to" is in the fanout cone of "from". Only gates of a lower level
+// than "to" can lead to it, so the search stops at level(to): the region is
+// empty unless the edit goes against the current order.
+bool
+CirMgr::reaches(CirGate* from, const CirGate* to)
+{
+   if (from == to) return true;
+   if (to->_level <= from->_level) return false;
+   ++_globalRef;
+   GateList stack(1, from);
+   from->_ref = _globalRef;
+   while (!stack.empty()) {
+      CirGate* g = stack.back();
+      stack.pop_back();
+      ++_nCycleVisits;
+      for (unsigned k = 0; k < g->_foNum; k++) {
+         CirGate* f = g->_fanout[k].gate();
+         if (f == to) return true;
+         if (f->_ref == _globalRef || f->_level >= to->_level) continue;
+         f->_ref = _globalRef;
+         stack.push_back(f);
+      }
+   }
+   return false;
+}
+
+// The fanins of "g" changed: recompute its level and then those of the
+// fanouts whose level changed with it. Gates are taken in the order of
+// their old levels, which every fanin of a gate is below, so each one is
+// recomputed once, after all its fanins.
+void
+CirMgr::updateLevels(CirGate* g)
+{
+   typedef pair<unsigned, CirGate*> LevelGate;
+   priority_queue<LevelGate, vector<LevelGate>, greater<LevelGate> > work;
+   ++_globalRef;
+   g->_ref = _globalRef;
+   work.push(LevelGate(g->_level, g));
+   while (!work.empty()) {
+      CirGate* h = work.top().second;
+      work.pop();
+      unsigned lv = 0;
+      for (unsigned j = 0; j < h->getFaninNum(); j++)
+         lv = max(lv, h->_fanin[j]->_level + 1);
+      if (lv == h->_level) continue;
+      h->_level = lv;
+      ++_nLevelUpdates;
+      for (unsigned k = 0; k < h->_foNum; k++) {
+         CirGate* f = h->_fanout[k].gate();
+         if (f->_ref == _globalRef) continue;
+         f->_ref = _globalRef;
+         work.push(LevelGate(f->_level, f));
+      }
+   }
+}
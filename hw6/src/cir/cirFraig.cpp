@@ -0,0 +1,306 @@
+/****************************************************************************
+  FileName     [ cirFraig.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir FRAIG functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "sat.h"
+#include "util.h"
+
+using namespace std;
+
+// Conflicts per SAT query before the pair is left unresolved
+#define FRAIG_SAT_BUDGET     100000
+// Random simulation stops after this many passes without a new class...
+#define FRAIG_SIM_STALL      3
+// ...or after this many passes in total
+#define FRAIG_MAX_SIM_ROUNDS 64
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static inline size_t
+litOf(const CirGateV& v)
+{
+   return 2 * size_t(v->getId()) + v.isInv();
+}
+
+// Open-addressed (linear probing) table of AIG gates keyed by their
+// unordered fanin literal pair. The size is a power of 2 of at least twice
+// the number of gates, so a probe sequence always ends at an empty slot.
+class StrashTable
+{
+public:
+   StrashTable(size_t nGates) {
+      size_t size = 16;
+      while (size < 2 * nGates) size <<= 1;
+      _table.assign(size, 0);
+      _mask = size - 1;
+   }
+
+   // Return the gate with the same fanins as "g"; insert "g" if none
+   CirGate* insert(CirGate* g) {
+      size_t k0 = litOf(g->getFanin(0)), k1 = litOf(g->getFanin(1));
+      if (k0 > k1) swap(k0, k1);
+      size_t i = hash(k0, k1) & _mask;
+      for (; _table[i]; i = (i + 1) & _mask) {
+         CirGate* h = _table[i];
+         size_t h0 = litOf(h->getFanin(0)), h1 = litOf(h->getFanin(1));
+         if (h0 > h1) swap(h0, h1);
+         if (h0 == k0 && h1 == k1) return h;
+      }
+      _table[i] = g;
+      return g;
+   }
+
+private:
+   GateList _table;
+   size_t   _mask;
+
+   static size_t hash(size_t k0, size_t k1) {
+      size_t h = k0 * 0x9e3779b97f4a7c15ULL ^ (k1 + 0x632be59bd9b4e019ULL);
+      return h ^ (h >> 29);
+   }
+};
+
+// Decide "a == b ^ inv" with one incremental SAT solver: every gate ID is
+// a variable, and a query adds the clauses of "x = a ^ b ^ inv" and assumes
+// x. A proven XOR is then fixed to 0, which the solver can use in later
+// queries. A gate is encoded the first time it is in the fanin cone of a
+// query; as queries come in DFS order, the encoded part is mostly the cones
+// seen so far, and propagation rarely leaves them. UNDEF gates are 0, as in
+// simulation.
+class SatProver
+{
+public:
+   enum Result { EQUAL, DIFF, UNKNOWN };
+
+   SatProver(CirMgr* mgr, size_t nGates):
+      _mgr(mgr), _encoded(nGates, false), _nQueries(0), _time(0) {
+      for (size_t id = 0; id < nGates; id++) _solver.newVar(false);
+   }
+
+   Result prove(CirGate* a, CirGate* b, bool inv) {
+      GateList roots(1, a);
+      roots.push_back(b);
+      _cone.clear();
+      _mgr->dfsOrder(roots, _cone);
+      for (size_t c = 0; c < _cone.size(); c++) {
+         encode(_cone[c]);
+         _solver.setDecisionVar(_cone[c]->getId(), true);
+      }
+      Var x = _solver.newVar(false);
+      _solver.addXorCNF(x, a->getId(), false, b->getId(), inv);
+      _solver.assumeRelease();
+      _solver.assumeProperty(x, true);
+      double start = getWallTime();
+      SatResult r = _solver.assumpSolve(FRAIG_SAT_BUDGET);
+      _time += getWallTime() - start;
+      ++_nQueries;
+      for (size_t c = 0; c < _cone.size(); c++)
+         _solver.setDecisionVar(_cone[c]->getId(), false);
+      if (r == SAT_SAT) return DIFF;
+      if (r == SAT_UNDEF) return UNKNOWN;
+      vector<Lit> unit(1, mkLit(x, true));
+      _solver.addClause(unit);
+      return EQUAL;
+   }
+   // Value of "g" in the counter-example of the last DIFF
+   bool value(const CirGate* g) const { return _solver.getValue(g->getId()); }
+
+   size_t nQueries() const { return _nQueries; }
+   size_t nConflicts() const { return _solver.nConflicts(); }
+   double time() const { return _time; }
+
+private:
+   CirMgr*         _mgr;
+   SatSolver       _solver;
+   vector<bool>    _encoded;   // by gate ID
+   GateList        _cone;
+   size_t          _nQueries;
+   double          _time;
+
+   void encode(const CirGate* g) {
+      unsigned id = g->getId();
+      if (_encoded[id]) return;
+      _encoded[id] = true;
+      if (g->getType() == AIG_GATE) {
+         const CirGateV& f0 = g->getFanin(0);
+         const CirGateV& f1 = g->getFanin(1);
+         _solver.addAigCNF(id, f0->getId(), f0.isInv(), f1->getId(), f1.isInv());
+      }
+      else if (g->getType() != PI_GATE) {
+         vector<Lit> unit(1, mkLit(id, true));
+         _solver.addClause(unit);
+      }
+   }
+};
+
+/*******************************************/
+/*   Public member functions about fraig   */
+/*******************************************/
+// Merge AIG gates with identical fanins. _dfsList is in topological order,
+// so the fanins of a gate are final by the time it is hashed.
+void
+CirMgr::strash()
+{
+   CirPhaseMark mark = phaseMark();
+   double start = getWallTime();
+   vector<CirGateV> repl(_Gatelist.size());
+   StrashTable table(A);
+   unsigned nMerged = 0;
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE) continue;
+      replaceFanin(g, repl);
+      CirGate* h = table.insert(g);
+      if (h != g) {
+         repl[g->_id] = CirGateV(h);
+         ++nMerged;
+      }
+   }
+   applyReplace(repl);
+   cout << "Strashing: " << nMerged << " AIG gate(s) merged in "
+        << setprecision(4) << getWallTime() - start << " seconds." << endl;
+   endPhase("strash", mark);
+}
+
+// Merge functionally equivalent gates:
+// 1. Random simulation splits CONST0 and the AIGs into candidate classes.
+// 2. In DFS order, each AIG is checked against the first member of its
+//    class. Proven pairs are merged; a counter-example is queued as a
+//    simulation pattern, and once a pass worth of them is queued they are
+//    simulated and the classes refined, which also separates every other
+//    pair the patterns tell apart.
+// 3. Step 2 repeats until it finds no more counter-examples.
+void
+CirMgr::fraig()
+{
+   CirPhaseMark mark = phaseMark();
+   double start = getWallTime();
+   buildSimList();
+   if (_fecGrpBegin.empty()) initFecGrps();
+   vector<size_t> piWords(I * _simWords);
+   for (unsigned r = 0, stall = 0;
+        r < FRAIG_MAX_SIM_ROUNDS && stall < FRAIG_SIM_STALL && fecGrpNum();
+        r++) {
+      size_t nGrps = fecGrpNum();
+      randomPatterns(piWords);
+      simulate(piWords);
+      refineFecGrps();
+      stall = fecGrpNum() == nGrps? stall + 1: 0;
+   }
+   size_t nSimGrps = fecGrpNum();
+
+   vector<CirGateV> repl(_Gatelist.size());
+   IdList unresolved(_Gatelist.size(), 0);   // 1 + ID of the last UNKNOWN rep
+   SatProver prover(this, _Gatelist.size());
+   unsigned passBits = _simWords * SIM_WORD_BITS, nCex = 0;
+   unsigned nEqual = 0, nDiff = 0, nUnknown = 0;
+   randomPatterns(piWords);
+   for (bool refuted = true; refuted; ) {
+      refuted = false;
+      for (size_t i = 0; i < _dfsList.size(); i++) {
+         CirGate* g = _dfsList[i];
+         if (g->_type != AIG_GATE || _fecGrpOf[g->_id] == FEC_NONE) continue;
+         unsigned repLit = _fecList[_fecGrpBegin[_fecGrpOf[g->_id]]];
+         CirGate* rep = _Gatelist[repLit / 2];
+         if (rep == g || unresolved[g->_id] == rep->_id + 1) continue;
+         bool inv = (repLit ^ _simValue[g->_id * _simWords]) & 1;
+         switch (prover.prove(rep, g, inv)) {
+         case SatProver::EQUAL:
+            repl[g->_id] = CirGateV(rep, inv);
+            _fecGrpOf[g->_id] = FEC_NONE;
+            ++nEqual;
+            break;
+         case SatProver::UNKNOWN:
+            unresolved[g->_id] = rep->_id + 1;
+            ++nUnknown;
+            break;
+         case SatProver::DIFF:
+            refuted = true;
+            ++nDiff;
+            for (unsigned k = 0; k < I; k++) {
+               size_t& word = piWords[k * _simWords + nCex / SIM_WORD_BITS];
+               size_t bit = size_t(1) << (nCex % SIM_WORD_BITS);
+               word = prover.value(_in[k])? (word | bit): (word & ~bit);
+            }
+            if (++nCex == passBits) {
+               simulate(piWords);
+               refineFecGrps();
+               randomPatterns(piWords);
+               nCex = 0;
+            }
+            break;
+         }
+      }
+      if (nCex) {
+         simulate(piWords);
+         refineFecGrps();
+         randomPatterns(piWords);
+         nCex = 0;
+      }
+   }
+   applyReplace(repl);
+   cout << "Fraig: " << nEqual << " AIG gate(s) merged in " << setprecision(4)
+        << getWallTime() - start << " seconds." << endl
+        << "  " << nSimGrps << " candidate class(es) after simulation; "
+        << nEqual << " pair(s) proved, " << nDiff << " refuted, "
+        << nUnknown << " unresolved" << endl
+        << "  " << prover.nQueries() << " SAT queries, "
+        << prover.nConflicts() << " conflicts in " << setprecision(4)
+        << prover.time() << " seconds ("
+        << (prover.time() > 0? prover.nQueries() / prover.time(): 0)
+        << " queries/s)" << endl;
+   endPhase("fraig", mark);
+}
+
+/********************************************/
+/*   Private member functions about fraig   */
+/********************************************/
+// Redirect the fanins of "g" to their replacements, keeping the phase
+void
+CirMgr::replaceFanin(CirGate* g, const vector<CirGateV>& repl) const
+{
+   for (unsigned j = 0; j < g->getFaninNum(); j++) {
+      const CirGateV& r = repl[g->_fanin[j]->_id];
+      if (r.gate())
+         g->_fanin[j] = CirGateV(r.gate(), r.isInv() ^ g->_fanin[j].isInv());
+   }
+}
+
+// Every gate with repl[id] set is removed and its fanouts are redirected
+// to repl[id]; a replacement must not be replaced itself.
+void
+CirMgr::applyReplace(const vector<CirGateV>& repl)
+{
+   for (size_t i = 0; i < _aig.size(); i++)
+      replaceFanin(_aig[i], repl);
+   for (size_t i = 0; i < _out.size(); i++)
+      replaceFanin(_out[i], repl);
+   size_t n = 0;
+   for (size_t i = 0; i < _aig.size(); i++) {
+      CirGate* g = _aig[i];
+      if (repl[g->_id].gate()) {
+         _Gatelist[g->_id] = 0;
+         _mem.free(g, sizeof(*g));
+      }
+      else _aig[n++] = g;
+   }
+   _aig.resize(n);
+   A = n;
+   buildFanout();
+   DFS();
+   clearFecGrps();
+}
@@ -8,9 +8,9 @@
 
 #include <iostream>
 #include <iomanip>
-#include <sstream>
 #include <stdarg.h>
 #include <cassert>
+#include <cstring>
 #include "cirGate.h"
 #include "cirMgr.h"
 #include "util.h"
@@ -26,79 +26,115 @@ extern CirMgr *cirMgr;
 /**************************************/
 unsigned CirGate::_gmark =0;
 
+static unsigned
+numDigits(unsigned n)
+{
+   unsigned d = 1;
+   for (; n >= 10; n /= 10) d++;
+   return d;
+}
+
 void
 CirGate::reportGate() const
 {
-   cout << "==================================================" << endl;
-   stringstream ss;
-   ss << "= " + getTypeStr() << '(' << _id << ")";
-   if (_name != "") {
-      ss << "\"" << _name << "\"";
+   CirOutBuf out(cout);
+   reportGate(out);
+}
+
+// The report is formatted straight from the gate into "out"; the second
+// line is padded to 49 columns, as setw(49) would
+void
+CirGate::reportGate(CirOutBuf& out) const
+{
+   static const char* bar =
+      "==================================================\n";
+   const char* type = typeStr(_type);
+   size_t len = strlen(type) + numDigits(_id) + numDigits(_lineNo) + 11;
+   out << bar << "= " << type << '(' << _id << ')';
+   if (_name) {
+      out << '"' << _name << '"';
+      len += strlen(_name) + 2;
    }
-   ss << ", line " << getLineNo();
-   cout << setw(49) << left << ss.str() << "=" << endl;
-   cout << "==================================================" << endl;
+   out << ", line " << _lineNo;
+   for (; len < 49; len++) out << ' ';
+   out << "=\n" << bar;
 }
 
+// The cone reports of CIRGate -FANIn/-FANOut are cached by cirMgr
 void
 CirGate::reportFanin(int level) const
 {
    assert (level >= 0);
-   _gmark++;
-   dfs_fanin(level, 0);
+   cirMgr->reportCone(this, level, false);
 }
 
 void
 CirGate::reportFanout(int level) const
 {
    assert (level >= 0);
-   _gmark++;
-   dfs_fanout(level, 0);  
+   cirMgr->reportCone(this, level, true);
 }
 
-void
-CirGate::dfs_fanin(int level, int cur) const
+// Append the fanin (or fanout) cone of this gate to "out", one gate per
+// line indented by its depth, in DFS preorder. The direct fanins are always
+// listed; a gate at depth d is expanded only if d <= level. An expanded
+// gate seen again is not expanded but marked "(*)". The DFS keeps its own
+// stack, so a deep cone does not recurse.
+// Whenever "out" grows past "spill" bytes, it is written to "os" and
+// emptied; return false if that happened, i.e. "out" is not the whole report
+bool
+CirGate::writeCone(int level, bool fanout, string& out, ostream& os,
+                   size_t spill) const
 {
-   if(level != -1) if(cur > level) return;
-   int _cur = cur;
-   if(_fanin.size()) _mark = _gmark;
-   if(_cur == 0) {
-      cout << getTypeStr() << " " << _id << endl;
-      _mark = _gmark;
-      ++_cur;
-   }
-   for(int n = 0; n < _fanin.size(); ++n) {
-      for(int m = 0; m < _cur; ++m) cout << "  ";
-      if(_invert[n]) cout << "!";
-      cout << _fanin[n]->getTypeStr() << " " << _fanin[n]->_id;
-      if(_fanin[n]->_mark == _gmark) { cout << " (*)" << endl; }
-      else {
-         cout << endl;
-         _fanin[n]->dfs_fanin( level, _cur + 1);
+   struct Frame {
+      const CirGate*  _gate;
+      unsigned        _depth;   // of its fanins/fanouts
+      unsigned        _next;
+   };
+   vector<Frame> stack;
+   bool whole = true;
+   ++_gmark;
+   out += getTypeStr();
+   out += ' ';
+   appendUint(_id, out);
+   out += '\n';
+   _mark = _gmark;
+   Frame root = { this, 1, 0 };
+   stack.push_back(root);
+   while (!stack.empty()) {
+      if (out.size() > spill) {
+         os.write(out.data(), out.size());
+         out.clear();
+         whole = false;
       }
+      Frame& f = stack.back();
+      unsigned num = fanout? f._gate->_foNum: f._gate->getFaninNum();
+      if (f._next == num) { stack.pop_back(); continue; }
+      const CirGateV& v = fanout? f._gate->_fanout[f._next]:
+                                  f._gate->_fanin[f._next];
+      ++f._next;
+      unsigned depth = f._depth;
+      out.append(2 * depth, ' ');
+      if (v.isInv()) out += '!';
+      out += v->getTypeStr();
+      out += ' ';
+      appendUint(v->_id, out);
+      if (v->_mark == _gmark) { out += " (*)\n"; continue; }
+      out += '\n';
+      unsigned vNum = fanout? v->_foNum: v->getFaninNum();
+      if (int(depth) + 1 > level || !vNum) continue;
+      v->_mark = _gmark;
+      Frame next = { v.gate(), depth + 1, 0 };
+      stack.push_back(next);
    }
+   return whole;
 }
 
-void 
-CirGate::dfs_fanout(int level, int cur) const
+void
+CirGate::appendUint(unsigned n, string& out)
 {
-   if(level != -1) if(cur > level) return;
-   int _cur = cur;
-   if(_fanout.size()) _mark = _gmark;
-   if(_cur == 0) {
-      cout << getTypeStr() << " " << _id << endl;
-      _mark = _gmark;
-      ++_cur;
-   }
-   for(int n = 0; n < _fanout.size(); ++n) {
-      for(int m = 0; m < _cur; ++m) cout << "  ";
-      if(_outinvert[n]) cout << "!";
-      cout << _fanout[n]->getTypeStr() << " " << _fanout[n]->_id;
-      if(_fanout[n]->_mark == _gmark) { cout << " (*)" << endl; }
-      else {
-         cout << endl;
-         _fanout[n]->dfs_fanout(level, _cur + 1);
-      }
-   }
-   
+   char buf[16];
+   char* p = buf + sizeof(buf);
+   do { *--p = '0' + n % 10; n /= 10; } while (n);
+   out.append(p, buf + sizeof(buf) - p);
 }
@@ -13,6 +13,8 @@
 #include <vector>
 #include <iostream>
 #include "cirDef.h"
+#include "cirMem.h"
+#include "cirOut.h"
 
 using namespace std;
 
@@ -21,18 +23,38 @@ class CirGate;
 //------------------------------------------------------------------------
 //   Define classes
 //------------------------------------------------------------------------
+// A fanin/fanout literal: gate pointer with the inverted flag in bit 0
+class CirGateV
+{
+public:
+  #define NEG 0x1
+  CirGateV(CirGate* g = 0, size_t phase = 0): _gateV(size_t(g) + phase) {}
+  CirGate* gate() const { return (CirGate*)(_gateV & ~size_t(NEG)); }
+  bool isInv() const { return (_gateV & NEG); }
+  CirGate* operator -> () const { return gate(); }
+  bool operator == (const CirGateV& v) const { return _gateV == v._gateV; }
+  bool operator != (const CirGateV& v) const { return _gateV != v._gateV; }
+
+private:
+  size_t _gateV;
+};
+
 // TODO: Define your own data members and member functions, or classes
 class CirGate
 {
 public:
   friend class CirMgr;
 
-  CirGate(GateType type, unsigned id, unsigned lineNo): _type(type), _id(id), _lineNo(lineNo) , _fanin(0), _fanout(0), _name("") {}
-  virtual ~CirGate() {}
+  CirGate(GateType type, unsigned id, unsigned lineNo): _ref(0), _mark(0), _type(type), _id(id), _lineNo(lineNo), _fanout(0), _foNum(0), _level(0), _name(0) {}
+
+  // Gates are placed in the CirMemMgr of their circuit and are never
+  // destroyed one by one: CirMgr frees them with the arena
+  void* operator new(size_t t, CirMemMgr& mem) { return mem.alloc(t); }
+  void operator delete(void*, CirMemMgr&) {}
 
   // Basic access methods
-  string getTypeStr() const { 
-  switch (_type) {
+  static const char* typeStr(GateType type) {
+    switch (type) {
     case UNDEF_GATE: return "UNDEF";
     case PI_GATE:    return "PI";
     case PO_GATE:    return "PO";
@@ -41,11 +63,24 @@ public:
     default:         return "";
     }
   }
+  string getTypeStr() const { return typeStr(_type); }
   unsigned getLineNo() const { return _lineNo; }
+  unsigned getId() const { return _id; }
+  GateType getType() const { return _type; }
+  const CirGateV& getFanin(unsigned i) const { return _fanin[i]; }
+  // AIG: 2, PO: 1, others: 0
+  unsigned getFaninNum() const {
+    return _type == AIG_GATE? 2: (_type == PO_GATE? 1: 0);
+  }
+  unsigned getFanoutNum() const { return _foNum; }
+  // PI/CONST/UNDEF: 0; AIG/PO: 1 + max fanin level. Only kept up to date
+  // for the gates in the DFS list
+  unsigned getLevel() const { return _level; }
 
   // Printing functions
-  virtual void printGate() const = 0;
+  virtual void printGate(CirOutBuf& out) const = 0;
   void reportGate() const;
+  void reportGate(CirOutBuf& out) const;
   void reportFanin(int level) const;
   void reportFanout(int level) const;
 
@@ -55,53 +90,54 @@ public:
   // for DFS -fanin -fanout
   static unsigned _gmark;
   mutable unsigned _mark;
-  void dfs_fanin(int level, int cur) const;
-  void dfs_fanout(int level, int cur) const;
+  bool writeCone(int level, bool fanout, string& out, ostream& os,
+                 size_t spill) const;
   
 private:
+  static void appendUint(unsigned n, string& out);
   
 protected:
   GateType _type;
   unsigned _id;
   unsigned _lineNo;
-  GateList _fanin;
-  GateList _fanout;
-  vector<bool> _invert;
-  vector<bool> _outinvert;
-  string _name;
+  CirGateV _fanin[2];
+  CirGateV* _fanout;   // points into CirMgr::_fanoutPool
+  unsigned _foNum;
+  unsigned _level;
+  const char* _name;   // in CirMgr::_mem; 0 if none
 };
 
 class CirConstGate: public CirGate  {
 public:
   CirConstGate(): CirGate(CONST_GATE, 0, 0) {}
-  void printGate() const { cout << "CONST0"; } 
+  void printGate(CirOutBuf& out) const { out << "CONST0"; }
 };
 
 class CirPiGate: public CirGate  {
 public:
   CirPiGate(unsigned id, unsigned lineNo): CirGate(PI_GATE, id, lineNo) {}
-  void printGate() const { 
-    cout << "PI  " << _id;
-    if(_name!="") cout << " (" << _name << ")";
+  void printGate(CirOutBuf& out) const {
+    out << "PI  " << _id;
+    if(_name) out << " (" << _name << ")";
   }
 };
 
 class CirPoGate: public CirGate  {
 public:
   CirPoGate(unsigned id, unsigned lineNo): CirGate(PO_GATE, id, lineNo) {}
-  void printGate() const { cout << "PO  " << _id << " "; }
+  void printGate(CirOutBuf& out) const { out << "PO  " << _id << " "; }
 };
 
 class CirAigGate: public CirGate {
 public:
   CirAigGate(unsigned id, unsigned lineNo): CirGate(AIG_GATE, id, lineNo) {}
-  void printGate() const { cout << "AIG " << _id << " "; }
+  void printGate(CirOutBuf& out) const { out << "AIG " << _id << " "; }
 };
 
 class CirUndefGate: public CirGate  {
 public:
   CirUndefGate(unsigned id): CirGate(UNDEF_GATE, id, 0) {}
-  void printGate() const { cout << "UNDEF " << _id; }
+  void printGate(CirOutBuf& out) const { out << "UNDEF " << _id; }
 };
 
 #endif // CIR_GATE_H
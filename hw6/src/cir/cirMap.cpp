@@ -0,0 +1,589 @@
+/****************************************************************************
+  FileName     [ cirMap.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir k-LUT technology mapping functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// Largest LUT size; the function of a cut fits in one 64-bit truth table
+#define MAP_K_MAX        6
+// Priority cuts kept per gate
+#define MAP_CUT_MAX      8
+// Area-flow and exact-area passes after the delay-oriented one
+#define MAP_FLOW_PASSES  1
+#define MAP_AREA_PASSES  2
+#define MAP_NO_SLOT      unsigned(-1)
+#define MAP_INF          unsigned(-1)
+// Area flows closer than this are equal
+#define MAP_EPS          0.005f
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Truth tables are over the leaves of a cut: bit m is the value when leaf
+// i is bit i of m. Variables above the leaf count are don't cares, i.e. a
+// table over n leaves repeats every 2^n bits.
+static const size_t mapVarTruth[MAP_K_MAX] = {
+   0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+   0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+// Up to MAP_K_MAX gate IDs in ascending order, the function of the cut
+// root over them, and the costs of the cut as a LUT
+struct CirMapCut
+{
+   unsigned    _leaf[MAP_K_MAX];
+   unsigned    _nLeaves;
+   unsigned    _delay;    // LUT levels
+   unsigned    _area;     // exact area; only in exact-area passes
+   float       _flow;     // area flow
+   size_t      _truth;
+   size_t      _sign;     // bit (ID % 64) of every leaf
+};
+
+static inline size_t
+mapSign(unsigned id)
+{
+   return size_t(1) << (id & 63);
+}
+
+// Swap variables v and v+1
+static inline size_t
+mapSwap(size_t t, unsigned v)
+{
+   static const size_t masks[MAP_K_MAX - 1][3] = {
+      { 0x9999999999999999ULL, 0x2222222222222222ULL, 0x4444444444444444ULL },
+      { 0xC3C3C3C3C3C3C3C3ULL, 0x0C0C0C0C0C0C0C0CULL, 0x3030303030303030ULL },
+      { 0xF00FF00FF00FF00FULL, 0x00F000F000F000F0ULL, 0x0F000F000F000F00ULL },
+      { 0xFF0000FFFF0000FFULL, 0x0000FF000000FF00ULL, 0x00FF000000FF0000ULL },
+      { 0xFFFF00000000FFFFULL, 0x00000000FFFF0000ULL, 0x0000FFFF00000000ULL }
+   };
+   unsigned s = 1u << v;
+   return (t & masks[v][0]) | ((t & masks[v][1]) << s) |
+          ((t & masks[v][2]) >> s);
+}
+
+static inline bool
+mapDepends(size_t t, unsigned v)
+{
+   return ((t >> (1u << v)) ^ t) & ~mapVarTruth[v];
+}
+
+// The truth table of "a" over the leaves of "c", which contain those of "a"
+static size_t
+mapStretch(const CirMapCut& a, const CirMapCut& c)
+{
+   unsigned pos[MAP_K_MAX];
+   for (unsigned i = 0, j = 0; i < a._nLeaves; i++, j++) {
+      while (c._leaf[j] != a._leaf[i]) ++j;
+      pos[i] = j;
+   }
+   size_t t = a._truth;
+   for (unsigned i = a._nLeaves; i-- > 0; )
+      for (unsigned v = i; v < pos[i]; v++) t = mapSwap(t, v);
+   return t;
+}
+
+// Drop the leaves the function of "c" does not depend on
+static void
+mapShrink(CirMapCut& c)
+{
+   unsigned n = 0;
+   for (unsigned v = 0; v < c._nLeaves; v++) {
+      if (!mapDepends(c._truth, v)) continue;
+      for (unsigned u = v; u > n; u--) c._truth = mapSwap(c._truth, u - 1);
+      c._leaf[n++] = c._leaf[v];
+   }
+   if (n == c._nLeaves) return;
+   c._nLeaves = n;
+   c._sign = 0;
+   for (unsigned i = 0; i < n; i++) c._sign |= mapSign(c._leaf[i]);
+}
+
+// Whether the leaves of "a" are all in "b"
+static bool
+mapSubset(const CirMapCut& a, const CirMapCut& b)
+{
+   if (a._nLeaves > b._nLeaves || (a._sign & ~b._sign)) return false;
+   for (unsigned i = 0, j = 0; i < a._nLeaves; i++, j++) {
+      while (j < b._nLeaves && b._leaf[j] < a._leaf[i]) ++j;
+      if (j == b._nLeaves || b._leaf[j] != a._leaf[i]) return false;
+   }
+   return true;
+}
+
+// BLIF name of a LUT input or PO driver: PI or AIG
+static void
+blifSignal(CirOutBuf& out, const CirGate* g, const IdList& piOf,
+           const vector<string>& names)
+{
+   if (g->getType() == AIG_GATE) out << 'n' << g->getId();
+   else out << names[piOf[g->getId()]];
+}
+
+// Priority-cut mapper. Each pass visits the AIGs in DFS order and merges
+// the cut sets of the two fanins; of the merged cuts only the MAP_CUT_MAX
+// best under the cost of the pass are kept, and the first one becomes the
+// LUT of the gate if the gate is in the cover. The cost is
+// - DELAY: depth, then the number of leaves, then area flow;
+// - FLOW:  area flow (the LUTs of the cone, shared ones divided among
+//   their expected fanouts), then depth;
+// - AREA:  exact area, i.e. the LUTs that choosing the cut adds to the
+//   current cover, then depth.
+// After the first pass the depth is fixed: a cut arriving later than the
+// required time of its gate only wins when every cut does. The previous
+// LUT of a gate is always a candidate, so the cover does not get worse.
+// A cut set lives in a slot that is recycled once every AIG fanout of its
+// gate has been visited, so only the LUT of each gate is kept for the
+// whole run.
+class LutMapper
+{
+public:
+   enum Mode { DELAY, FLOW, AREA };
+
+   LutMapper(const GateList& dfsList, const GateList& outs, size_t nIds,
+             unsigned k);
+
+   void run(Mode mode);
+
+   // the cover of the last pass
+   bool used(unsigned id) const { return _mapRef[id]; }
+   const CirMapCut& lut(unsigned id) const { return _best[id]; }
+   unsigned area() const { return _area; }
+   unsigned depth() const { return _depth; }
+   size_t nCutsTried() const { return _nCutsTried; }
+   size_t nSlots() const { return _nCuts.size(); }
+
+private:
+   const GateList&   _dfsList;
+   const GateList&   _outs;
+   unsigned          _k;
+   Mode              _mode;
+   unsigned          _nPasses;
+   unsigned          _req;        // of the gate being mapped
+   vector<bool>      _isAig;      // by gate ID
+   IdList            _nFanouts;   // AIG fanouts in _dfsList
+   vector<CirMapCut> _best;       // LUT of each AIG
+   IdList            _arrival;
+   IdList            _required;   // MAP_INF: not in the cover
+   vector<float>     _flow;       // of the LUT of each AIG
+   vector<float>     _estRef;     // expected fanouts in the cover
+   IdList            _mapRef;     // fanouts in the cover
+   IdList            _pending;    // fanouts yet to take the cut set
+   IdList            _slot;
+   vector<CirMapCut> _cuts;       // MAP_CUT_MAX + 1 per slot
+   IdList            _nCuts;      // per slot
+   IdList            _freeSlots;
+   CirMapCut         _cand[MAP_CUT_MAX];
+   unsigned          _nCand;
+   CirMapCut         _leafCut[2];
+   IdList            _stack;
+   unsigned          _area, _depth;
+   unsigned          _target;     // depth after the first pass
+   size_t            _nCutsTried;
+
+   const CirMapCut* cutsOf(const CirGateV& f, unsigned j, unsigned& n);
+   void release(unsigned id);
+   void addCand(CirMapCut& c);
+   bool better(const CirMapCut& a, const CirMapCut& b) const;
+   unsigned refCut(const CirMapCut& c);
+   unsigned derefCut(const CirMapCut& c);
+   void cover();
+
+   // Leaves of "a" and "b" merged into "c"; false if there are more than _k
+   bool merge(const CirMapCut& a, const CirMapCut& b, CirMapCut& c) const {
+      unsigned i = 0, j = 0, n = 0;
+      while (i < a._nLeaves || j < b._nLeaves) {
+         if (n == _k) return false;
+         if (j == b._nLeaves || (i < a._nLeaves && a._leaf[i] < b._leaf[j]))
+            c._leaf[n++] = a._leaf[i++];
+         else if (i == a._nLeaves || b._leaf[j] < a._leaf[i])
+            c._leaf[n++] = b._leaf[j++];
+         else { c._leaf[n++] = a._leaf[i++]; ++j; }
+      }
+      c._nLeaves = n;
+      c._sign = a._sign | b._sign;
+      return true;
+   }
+};
+
+LutMapper::LutMapper(const GateList& dfsList, const GateList& outs,
+                     size_t nIds, unsigned k):
+   _dfsList(dfsList), _outs(outs), _k(k), _mode(DELAY), _nPasses(0),
+   _req(MAP_INF), _isAig(nIds, false), _nFanouts(nIds, 0), _best(nIds),
+   _arrival(nIds, 0), _required(nIds, MAP_INF), _flow(nIds, 0),
+   _estRef(nIds, 1), _mapRef(nIds, 0), _slot(nIds, MAP_NO_SLOT), _nCand(0),
+   _area(0), _depth(0), _target(0), _nCutsTried(0)
+{
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      if (g->getType() != AIG_GATE) continue;
+      _isAig[g->getId()] = true;
+      ++_nFanouts[g->getFanin(0)->getId()];
+      ++_nFanouts[g->getFanin(1)->getId()];
+      float n = g->getFanoutNum();
+      _estRef[g->getId()] = n > 1? n: 1;
+   }
+}
+
+void
+LutMapper::run(Mode mode)
+{
+   _mode = mode;
+   _pending = _nFanouts;
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      if (g->getType() != AIG_GATE) continue;
+      unsigned id = g->getId();
+      _req = _required[id];
+      if (_mode == AREA && _mapRef[id]) derefCut(_best[id]);
+
+      _nCand = 0;
+      if (_nPasses) {
+         CirMapCut c = _best[id];
+         addCand(c);
+      }
+      const CirGateV& f0 = g->getFanin(0);
+      const CirGateV& f1 = g->getFanin(1);
+      unsigned n0, n1;
+      const CirMapCut* c0 = cutsOf(f0, 0, n0);
+      const CirMapCut* c1 = cutsOf(f1, 1, n1);
+      for (unsigned a = 0; a < n0; a++)
+         for (unsigned b = 0; b < n1; b++) {
+            if (unsigned(__builtin_popcountll(c0[a]._sign | c1[b]._sign)) > _k)
+               continue;
+            CirMapCut c;
+            if (!merge(c0[a], c1[b], c)) continue;
+            size_t t0 = mapStretch(c0[a], c), t1 = mapStretch(c1[b], c);
+            c._truth = (f0.isInv()? ~t0: t0) & (f1.isInv()? ~t1: t1);
+            mapShrink(c);
+            addCand(c);
+         }
+      assert(_nCand);
+      _best[id] = _cand[0];
+      _arrival[id] = _cand[0]._delay;
+      _flow[id] = _cand[0]._flow;
+      if (_mode == AREA && _mapRef[id]) refCut(_best[id]);
+
+      // the cut set: the trivial cut, then the priority cuts
+      unsigned s;
+      if (_freeSlots.empty()) {
+         s = _nCuts.size();
+         _nCuts.push_back(0);
+         _cuts.resize(_cuts.size() + MAP_CUT_MAX + 1);
+      }
+      else { s = _freeSlots.back(); _freeSlots.pop_back(); }
+      CirMapCut* cuts = &_cuts[s * (MAP_CUT_MAX + 1)];
+      cuts[0]._leaf[0] = id;
+      cuts[0]._nLeaves = 1;
+      cuts[0]._truth = mapVarTruth[0];
+      cuts[0]._sign = mapSign(id);
+      for (unsigned c = 0; c < _nCand; c++) cuts[c + 1] = _cand[c];
+      _nCuts[s] = _nCand + 1;
+      _slot[id] = s;
+      if (!_pending[id]) release(id);
+      release(f0->getId());
+      release(f1->getId());
+   }
+   ++_nPasses;
+   cover();
+}
+
+// Cut set of fanin "f" of the gate being mapped; "j" picks the scratch
+// cut for a PI or a constant
+const CirMapCut*
+LutMapper::cutsOf(const CirGateV& f, unsigned j, unsigned& n)
+{
+   unsigned id = f->getId();
+   if (_isAig[id]) {
+      n = _nCuts[_slot[id]];
+      return &_cuts[_slot[id] * (MAP_CUT_MAX + 1)];
+   }
+   CirMapCut& c = _leafCut[j];
+   if (f->getType() == PI_GATE) {
+      c._leaf[0] = id;
+      c._nLeaves = 1;
+      c._truth = mapVarTruth[0];
+      c._sign = mapSign(id);
+   }
+   else {   // CONST0, or UNDEF taken as 0
+      c._nLeaves = 0;
+      c._truth = 0;
+      c._sign = 0;
+   }
+   n = 1;
+   return &c;
+}
+
+// One fanout of "id" has taken its cut set
+void
+LutMapper::release(unsigned id)
+{
+   if (!_isAig[id] || _slot[id] == MAP_NO_SLOT) return;
+   if (_pending[id] && --_pending[id]) return;
+   _freeSlots.push_back(_slot[id]);
+   _slot[id] = MAP_NO_SLOT;
+}
+
+// Evaluate "c" and keep it if it is among the MAP_CUT_MAX best; a cut is
+// dropped if a kept one has a subset of its leaves
+void
+LutMapper::addCand(CirMapCut& c)
+{
+   for (unsigned i = 0; i < _nCand; ) {
+      if (mapSubset(_cand[i], c)) return;
+      if (mapSubset(c, _cand[i])) {
+         for (unsigned j = i + 1; j < _nCand; j++) _cand[j - 1] = _cand[j];
+         --_nCand;
+      }
+      else ++i;
+   }
+   ++_nCutsTried;
+   unsigned delay = 0;
+   float flow = 1;
+   for (unsigned i = 0; i < c._nLeaves; i++) {
+      unsigned l = c._leaf[i];
+      if (_arrival[l] > delay) delay = _arrival[l];
+      flow += _flow[l] / _estRef[l];
+   }
+   c._delay = delay + 1;
+   c._flow = flow;
+   if (_mode == AREA) {
+      c._area = refCut(c);
+      derefCut(c);
+   }
+
+   unsigned i = _nCand;
+   if (i == MAP_CUT_MAX) {
+      if (!better(c, _cand[i - 1])) return;
+      --i;
+   }
+   else ++_nCand;
+   for (; i > 0 && better(c, _cand[i - 1]); i--) _cand[i] = _cand[i - 1];
+   _cand[i] = c;
+}
+
+bool
+LutMapper::better(const CirMapCut& a, const CirMapCut& b) const
+{
+   bool lateA = a._delay > _req, lateB = b._delay > _req;
+   if (lateA != lateB) return lateB;
+   if (lateA && a._delay != b._delay) return a._delay < b._delay;
+   if (_mode == AREA && a._area != b._area) return a._area < b._area;
+   if (_mode == DELAY) {
+      if (a._delay != b._delay) return a._delay < b._delay;
+      if (a._nLeaves != b._nLeaves) return a._nLeaves < b._nLeaves;
+   }
+   if (a._flow < b._flow - MAP_EPS) return true;
+   if (a._flow > b._flow + MAP_EPS) return false;
+   if (a._delay != b._delay) return a._delay < b._delay;
+   return a._nLeaves < b._nLeaves;
+}
+
+// Add the LUT of "c" to the cover, with the LUTs of the leaves it needs;
+// return the number of LUTs added
+unsigned
+LutMapper::refCut(const CirMapCut& c)
+{
+   unsigned area = 1;
+   _stack.assign(c._leaf, c._leaf + c._nLeaves);
+   while (!_stack.empty()) {
+      unsigned id = _stack.back();
+      _stack.pop_back();
+      if (!_isAig[id] || _mapRef[id]++) continue;
+      ++area;
+      const CirMapCut& b = _best[id];
+      _stack.insert(_stack.end(), b._leaf, b._leaf + b._nLeaves);
+   }
+   return area;
+}
+
+// Undo refCut(c); return the number of LUTs removed
+unsigned
+LutMapper::derefCut(const CirMapCut& c)
+{
+   unsigned area = 1;
+   _stack.assign(c._leaf, c._leaf + c._nLeaves);
+   while (!_stack.empty()) {
+      unsigned id = _stack.back();
+      _stack.pop_back();
+      if (!_isAig[id] || --_mapRef[id]) continue;
+      ++area;
+      const CirMapCut& b = _best[id];
+      _stack.insert(_stack.end(), b._leaf, b._leaf + b._nLeaves);
+   }
+   return area;
+}
+
+// Rebuild the cover from the POs; then the required times, which keep the
+// depth of the first pass at the POs, and the expected fanouts
+void
+LutMapper::cover()
+{
+   _mapRef.assign(_mapRef.size(), 0);
+   _area = _depth = 0;
+   for (size_t i = 0; i < _outs.size(); i++) {
+      unsigned id = _outs[i]->getFanin(0)->getId();
+      if (!_isAig[id]) continue;
+      if (_arrival[id] > _depth) _depth = _arrival[id];
+      if (!_mapRef[id]++) _area += refCut(_best[id]);
+   }
+   if (_nPasses == 1) _target = _depth;
+
+   for (size_t i = 0; i < _dfsList.size(); i++)
+      _required[_dfsList[i]->getId()] = MAP_INF;
+   for (size_t i = 0; i < _outs.size(); i++)
+      _required[_outs[i]->getFanin(0)->getId()] = _target;
+   for (size_t i = _dfsList.size(); i-- > 0; ) {
+      unsigned id = _dfsList[i]->getId();
+      if (!_isAig[id]) continue;
+      if (_mapRef[id]) {
+         const CirMapCut& c = _best[id];
+         for (unsigned j = 0; j < c._nLeaves; j++)
+            if (_required[c._leaf[j]] > _required[id] - 1)
+               _required[c._leaf[j]] = _required[id] - 1;
+      }
+      float est = (2 * _estRef[id] + _mapRef[id]) / 3;
+      _estRef[id] = est > 1? est: 1;
+   }
+}
+
+/*****************************************/
+/*   Public member functions about map   */
+/*****************************************/
+// Map the circuit to LUTs of at most "k" inputs: one delay-oriented pass,
+// then MAP_FLOW_PASSES area-flow and MAP_AREA_PASSES exact-area passes at
+// the same depth. The cover is written to "blif" if it is given.
+void
+CirMgr::lutMap(unsigned k, ostream* blif, const string& model) const
+{
+   assert(k >= 2 && k <= MAP_K_MAX);
+   CirPhaseMark mark = phaseMark();
+   double start = getWallTime();
+   LutMapper mapper(_dfsList, _out, _Gatelist.size(), k);
+   IdList areas;
+   mapper.run(LutMapper::DELAY);
+   areas.push_back(mapper.area());
+   for (unsigned p = 0; p < MAP_FLOW_PASSES; p++) {
+      mapper.run(LutMapper::FLOW);
+      areas.push_back(mapper.area());
+   }
+   for (unsigned p = 0; p < MAP_AREA_PASSES; p++) {
+      mapper.run(LutMapper::AREA);
+      areas.push_back(mapper.area());
+   }
+   double mapTime = getWallTime() - start;
+
+   unsigned nAig = 0, bySize[MAP_K_MAX + 1] = { 0 };
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE) continue;
+      ++nAig;
+      if (mapper.used(g->_id)) ++bySize[mapper.lut(g->_id)._nLeaves];
+   }
+   cout << "Mapping: " << nAig << " AIG gate(s) -> " << mapper.area() << ' '
+        << k << "-LUT(s), depth " << mapper.depth() << " in "
+        << setprecision(4) << mapTime << " seconds." << endl
+        << "  LUTs after each pass (delay, area flow, exact area):";
+   for (size_t p = 0; p < areas.size(); p++) cout << ' ' << areas[p];
+   cout << endl << "  LUTs by inputs:";
+   for (unsigned n = 0; n <= k; n++)
+      if (bySize[n]) cout << ' ' << n << ':' << bySize[n];
+   cout << endl << "  " << mapper.nCutsTried() << " cut(s) evaluated, "
+        << mapper.nSlots() << " cut set(s) alive at most" << endl;
+   endPhase("map", mark);
+   if (!blif) return;
+
+   // BLIF: a LUT is named n<ID>, and each PO is a buffer or inverter of
+   // its driver
+   vector<string> names;
+   blifNames(names);
+   IdList piOf(_Gatelist.size(), unsigned(-1));
+   for (unsigned i = 0; i < I; i++) piOf[_in[i]->_id] = i;
+   CirOutBuf out(*blif);
+   out << ".model " << model << "\n.inputs";
+   for (unsigned i = 0; i < I; i++) out << ' ' << names[i];
+   out << "\n.outputs";
+   for (unsigned i = 0; i < O; i++) out << ' ' << names[I + i];
+   out << '\n';
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE || !mapper.used(g->_id)) continue;
+      const CirMapCut& c = mapper.lut(g->_id);
+      out << ".names";
+      for (unsigned j = 0; j < c._nLeaves; j++) {
+         out << ' ';
+         blifSignal(out, _Gatelist[c._leaf[j]], piOf, names);
+      }
+      out << " n" << g->_id << '\n';
+      // the on-set or the off-set, whichever has fewer minterms
+      unsigned nRows = 1u << c._nLeaves, nOnes = 0;
+      for (unsigned m = 0; m < nRows; m++) nOnes += (c._truth >> m) & 1;
+      bool phase = 2 * nOnes <= nRows;
+      if (!c._nLeaves) {
+         if (nOnes) out << "1\n";
+         continue;
+      }
+      for (unsigned m = 0; m < nRows; m++) {
+         if (((c._truth >> m) & 1) != phase) continue;
+         for (unsigned j = 0; j < c._nLeaves; j++) out << char('0' + (m >> j & 1));
+         out << (phase? " 1\n": " 0\n");
+      }
+   }
+   for (unsigned i = 0; i < O; i++) {
+      const CirGateV& in = _out[i]->_fanin[0];
+      if (in->_type != PI_GATE && in->_type != AIG_GATE) {   // CONST0/UNDEF
+         out << ".names " << names[I + i] << (in.isInv()? "\n1\n": "\n");
+         continue;
+      }
+      out << ".names ";
+      blifSignal(out, in.gate(), piOf, names);
+      out << ' ' << names[I + i];
+      out << (in.isInv()? "\n0 1\n": "\n1 1\n");
+   }
+   out << ".end\n";
+}
+
+/******************************************/
+/*   Private member functions about map   */
+/******************************************/
+// Names of the PIs, then of the POs: the symbol, or i<k>/o<k> if there is
+// none. BLIF names must be unique, so a name that is taken, or that looks
+// like a LUT name n<ID>, gets '_' appended until it is free.
+void
+CirMgr::blifNames(vector<string>& names) const
+{
+   set<string> taken;
+   names.resize(I + O);
+   for (unsigned i = 0; i < I + O; i++) {
+      const CirGate* g = i < I? _in[i]: _out[i - I];
+      string& n = names[i];
+      if (g->_name) n = g->_name;
+      else {
+         ostringstream os;
+         os << (i < I? 'i': 'o') << (i < I? i: i - I);
+         n = os.str();
+      }
+      while (taken.count(n) ||
+             (n.size() > 1 && n[0] == 'n' &&
+              n.find_first_not_of("0123456789", 1) == string::npos))
+         n += '_';
+      taken.insert(n);
+   }
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+  FileName     [ cirMem.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the per-circuit memory arena for gates and names ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_MEM_H
+#define CIR_MEM_H
+
+#include <cassert>
+#include <cstring>
+#include <cstddef>
+
+using namespace std;
+
+// Bytes per arena block
+#define CIR_MEM_BLOCK_SIZE   (1 << 20)
+// Objects of up to this many size_t words are recycled by size
+#define CIR_MEM_R_SIZE       16
+
+// A trimmed-down MemMgr (hw4) owned by one CirMgr: objects are carved out
+// of big blocks, and a freed object goes to the recycle list of its size.
+// Nothing allocated here is destroyed one by one, so whatever is stored in
+// the arena must not own heap memory. The destructor releases the whole
+// circuit by freeing the blocks only.
+class CirMemMgr
+{
+public:
+   CirMemMgr(): _blocks(0), _ptr(0), _end(0), _nBlocks(0) {
+      memset(_recycleList, 0, sizeof(_recycleList));
+   }
+   ~CirMemMgr() { reset(); }
+
+   // Return "t" bytes aligned to size_t
+   void* alloc(size_t t) {
+      t = toWords(t);
+      if (t < CIR_MEM_R_SIZE && _recycleList[t]) {
+         void* ret = _recycleList[t];
+         _recycleList[t] = *(void**)ret;
+         return ret;
+      }
+      if (size_t(_end - _ptr) < t * sizeof(size_t)) newBlock(t);
+      void* ret = _ptr;
+      _ptr += t * sizeof(size_t);
+      return ret;
+   }
+   // "p" must come from alloc(t) of this arena
+   void free(void* p, size_t t) {
+      t = toWords(t);
+      if (t >= CIR_MEM_R_SIZE) return;
+      *(void**)p = _recycleList[t];
+      _recycleList[t] = p;
+   }
+   // Copy [begin, end) into the arena as a C string
+   const char* allocStr(const char* begin, const char* end) {
+      size_t n = end - begin;
+      char* s = (char*)alloc(n + 1);
+      memcpy(s, begin, n);
+      s[n] = '\0';
+      return s;
+   }
+   void reset() {
+      while (_blocks) {
+         char* next = *(char**)_blocks;
+         delete [] _blocks;
+         _blocks = next;
+      }
+      _ptr = _end = 0;
+      _nBlocks = 0;
+      memset(_recycleList, 0, sizeof(_recycleList));
+   }
+   size_t getNumBlocks() const { return _nBlocks; }
+
+private:
+   // Each block starts with a pointer to the previous block
+   char*    _blocks;
+   char*    _ptr;
+   char*    _end;
+   size_t   _nBlocks;
+   void*    _recycleList[CIR_MEM_R_SIZE];
+
+   static size_t toWords(size_t t) {
+      t = (t + sizeof(size_t) - 1) / sizeof(size_t);
+      return t? t: 1;
+   }
+   void newBlock(size_t words) {
+      size_t b = sizeof(char*) + words * sizeof(size_t);
+      if (b < CIR_MEM_BLOCK_SIZE) b = CIR_MEM_BLOCK_SIZE;
+      char* block = new char[b];
+      *(char**)block = _blocks;
+      _blocks = block;
+      _ptr = block + sizeof(char*);
+      _end = block + b;
+      ++_nBlocks;
+   }
+};
+
+#endif // CIR_MEM_H
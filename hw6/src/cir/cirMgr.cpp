@@ -12,6 +12,8 @@
 #include <ctype.h>
 #include <cassert>
 #include <cstring>
+#include <climits>
+#include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
@@ -19,11 +21,22 @@
 #include <sstream>
 #include <stdlib.h>
 #include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <new>
+#include <thread>
+#include <atomic>
 
 using namespace std;
 
 // TODO: Implement memeber functions for class CirMgr
 
+// Circuits with fewer AND gates are read on one thread regardless of
+// "CIRRead -Threads"
+#define READ_MT_MIN_GATES 20000
+
 /*******************************/
 /*   Global variable and enum  */
 /*******************************/
@@ -61,6 +74,7 @@ static char buf[1024];
 static string errMsg;
 static int errInt;
 static CirGate *errGate;
+char CirOutBuf::_buf[CIR_OUT_BUF_SIZE];
 
 static bool
 parseError(CirParseError err)
@@ -152,42 +166,253 @@ parseError(CirParseError err)
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
+CirMgr::~CirMgr()
+{
+   // the gates and names go away with _mem
+   deleteSimPool();
+}
+
+// The AAG file is mapped into memory and scanned exactly once. Literals are
+// decoded in place; "aagPtr" is the scanning cursor shared by the readXXX()
+// helpers below. For the binary "aig" format, inputs are implicit and the
+// AND gates are delta-encoded (see readDelta()).
+static const char* aagPtr = 0;
+static const char* aagEnd = 0;
+static bool aigBinary = false;
+
+static inline bool
+atEOF()
+{
+   return aagPtr >= aagEnd;
+}
+
+static inline bool
+atEOL()
+{
+   return aagPtr >= aagEnd || *aagPtr == '\n';
+}
+
+// The characters up to the next white space; the cursor is not moved
+static string
+peekToken()
+{
+   const char* end = aagPtr;
+   while (end < aagEnd && !isspace((unsigned char)*end)) ++end;
+   return string(aagPtr, end);
+}
+
+// Decode one unsigned decimal number that starts right at the cursor;
+// "what" names it in the error message
+static bool
+readNum(unsigned& num, const char* what)
+{
+   if (atEOL()) {
+      errMsg = what;
+      return parseError(MISSING_NUM);
+   }
+   if (*aagPtr == ' ') return parseError(EXTRA_SPACE);
+   if (isspace((unsigned char)*aagPtr)) {
+      errInt = *aagPtr;
+      return parseError(ILLEGAL_WSPACE);
+   }
+   const char* p = aagPtr;
+   unsigned long long value = 0;
+   while (p < aagEnd && isdigit((unsigned char)*p) && value <= UINT_MAX)
+      value = value * 10 + (*p++ - '0');
+   if (value > UINT_MAX || (p < aagEnd && !isspace((unsigned char)*p))) {
+      errMsg = string(what) + "(" + peekToken() + ")";
+      return parseError(ILLEGAL_NUM);
+   }
+   num = value;
+   colNo += p - aagPtr;
+   aagPtr = p;
+   return true;
+}
+
+// Exactly one space must separate two numbers. If "what" is given, a line
+// that ends here is missing that number instead.
+static bool
+readSpace(const char* what = 0)
+{
+   if (what && atEOL()) {
+      errMsg = what;
+      return parseError(MISSING_NUM);
+   }
+   if (atEOF() || *aagPtr != ' ') return parseError(MISSING_SPACE);
+   ++aagPtr; ++colNo;
+   return true;
+}
+
+// Nothing may follow the last number of a line
+static bool
+checkNewline()
+{
+   return atEOL() || parseError(MISSING_NEWLINE);
+}
+
+// A PI, PO or AIG line is only complete if it ends in a newline
+static bool
+checkLine(const char* what)
+{
+   if (!atEOF() && memchr(aagPtr, '\n', aagEnd - aagPtr)) return true;
+   errMsg = what;
+   return parseError(MISSING_DEF);
+}
+
+// Decode one 7-bit-per-byte delta of a binary AND gate
+static bool
+readDelta(unsigned& delta)
+{
+   delta = 0;
+   unsigned shift = 0;
+   unsigned char ch;
+   do {
+      if (atEOF()) return false;
+      ch = *aagPtr++;
+      delta |= (ch & 0x7f) << shift;
+      shift += 7;
+   } while (ch & 0x80);
+   return true;
+}
+
+static void
+writeDelta(CirOutBuf& out, unsigned delta)
+{
+   while (delta & ~0x7f) {
+      out << (char)((delta & 0x7f) | 0x80);
+      delta >>= 7;
+   }
+   out << (char)delta;
+}
+
+static string
+uintStr(unsigned num)
+{
+   char str[16];
+   snprintf(str, sizeof(str), "%u", num);
+   return str;
+}
+
+// Move the cursor to the beginning of the next line;
+// return the end of the current line
+static const char*
+skipLine()
+{
+   const char* eol = (const char*)memchr(aagPtr, '\n', aagEnd - aagPtr);
+   if (!eol) eol = aagEnd;
+   aagPtr = (eol == aagEnd)? eol: eol + 1;
+   ++lineNo; colNo = 0;
+   return eol;
+}
+
+// A byte range of the AND section, read by one thread of readAigParallel()
+struct CirAndChunk
+{
+   const char*    _begin;
+   const char*    _end;
+   size_t         _first;   // index in _aig of its first line
+   size_t         _nLines;
+   const char*    _next;    // past the AND section if it ends here; else 0
+};
+
+// Decode "lhs rhs0 rhs1\n" with single spaces and no other characters, as
+// AIGER writers emit it; "p" is moved past the line. Anything else is left
+// to the sequential parser, which knows how to report it. A line that runs
+// into "end" has no newline and is refused, for "end" may cut it short.
+static bool
+decodeAndLine(const char*& p, const char* end, unsigned* lits,
+              const char*& eol)
+{
+   for (int k = 0; k < 3; k++) {
+      if (p == end || !isdigit(*p)) return false;
+      unsigned num = 0;
+      do {
+         if (num >= UINT_MAX / 10) return false;
+         num = num * 10 + (*p++ - '0');
+      } while (p != end && isdigit(*p));
+      lits[k] = num;
+      if (k == 2) break;
+      if (p == end || *p != ' ') return false;
+      ++p;
+   }
+   if (p == end || *p != '\n') return false;
+   eol = p++;
+   return true;
+}
+
+static void
+countChunkLines(CirAndChunk* c)
+{
+   size_t n = 0;
+   const char* p = c->_begin;
+   while (p < c->_end) {
+      const char* eol = (const char*)memchr(p, '\n', c->_end - p);
+      if (!eol) { ++n; break; }
+      ++n;
+      p = eol + 1;
+   }
+   c->_nLines = n;
+}
+
 bool
-CirMgr::readCircuit(const string& fileName)
+CirMgr::readCircuit(const string& fileName, unsigned nThreads)
 {
-   // 1. READ IN ENTIRE FILE
-   ifstream infile;
-   infile.open("./" + fileName);
-   if (infile.fail()) {
+   _readThreads = nThreads? nThreads: 1;
+   CirPhaseMark mark = phaseMark();
+   // 1. MAP THE ENTIRE FILE
+   int fd = open(fileName.c_str(), O_RDONLY);
+   if (fd < 0) {
       cerr<<"Cannot open design \""<<fileName<<"\"!!"<<endl;
       return false;
    }
-   stringstream strStream;
-   strStream << infile.rdbuf();
-   string aagstring = strStream.str();
-   // 2. SPLIT THE STRING WITH \n
-   string::size_type pos1, pos2;
-   string c = "\n";
-   pos2 = aagstring.find(c);
-   pos1 = 0;
-   while(string::npos != pos2)
-   {
-      l.push_back(aagstring.substr(pos1, pos2-pos1));
-      pos1 = pos2 + c.size();
-      pos2 = aagstring.find(c, pos1);
-   }
-   if(pos1 != aagstring.length())
-      l.push_back(aagstring.substr(pos1));
-   // 3. read the GATE
-   readHeader();
-   _Gatelist[0] = new CirConstGate();
-   readInput();
-   readOutput();
-   readAig();
-   readComment();
-   connection();
-   DFS();
-   return true;
+   struct stat st;
+   if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      lineNo = colNo = 0;
+      errMsg = "aag";
+      return parseError(MISSING_IDENTIFIER);
+   }
+   size_t fileSize = st.st_size;
+   void* mem = mmap(0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (mem == MAP_FAILED) {
+      cerr<<"Cannot open design \""<<fileName<<"\"!!"<<endl;
+      return false;
+   }
+   aagPtr = (const char*)mem;
+   aagEnd = aagPtr + fileSize;
+   lineNo = colNo = 0;
+   // 2. read the GATE in one pass
+   bool ok = readHeader();
+   endPhase("header", mark);
+   if (ok) {
+      _Gatelist[0] = new (_mem) CirConstGate();
+      ok = readInput();
+      endPhase("inputs", mark);
+   }
+   if (ok) {
+      ok = readOutput();
+      endPhase("outputs", mark);
+   }
+   if (ok) {
+      ok = readAig();
+      endPhase("aigs", mark);
+   }
+   if (ok) {
+      ok = readComment();
+      endPhase("comments", mark);
+   }
+   if (ok) {
+      ok = connection();
+      endPhase("connection", mark);
+   }
+   if (ok) {
+      DFS();
+      endPhase("dfs", mark);
+   }
+   munmap(mem, fileSize);
+   aagPtr = aagEnd = 0;
+   return ok;
 }
 
 /**********************************************************/
@@ -213,53 +438,46 @@ CirMgr::printSummary() const
    cout << "  AIG   " << setw(8) << right << A << endl;
    cout << "------------------" << endl;
    cout << "  Total " << setw(8) << right << I+O+A << endl;
+   cout << "------------------" << endl;
+   cout << "  Depth " << setw(8) << right << _depth << endl;
+   if (!_depth) return;
+   // #AIGs in the DFS list per level, in at most SUMMARY_LEVEL_ROWS rows
+   // of equal level ranges
+   cout << "  " << setw(7) << left << "Level" << setw(7) << right << "#AIG"
+        << endl;
+   unsigned width = (_depth + SUMMARY_LEVEL_ROWS - 1) / SUMMARY_LEVEL_ROWS;
+   for (unsigned lo = 1; lo <= _depth; lo += width) {
+      unsigned hi = min(lo + width - 1, _depth);
+      size_t nAig = 0;
+      for (size_t i = _levelStart[lo]; i < _levelStart[hi + 1]; i++)
+         if (_levelList[i]->_type == AIG_GATE) ++nAig;
+      stringstream ss;
+      ss << lo;
+      if (hi > lo) ss << "-" << hi;
+      cout << "  " << setw(7) << left << ss.str() << setw(7) << right << nAig
+           << endl;
+   }
 }
 
 void
 CirMgr::printNetlist() const
 {
-   // cout<<_dfsList.size()<<endl;
+   CirOutBuf out(cout);
    unsigned n = 0;
-   cout<<endl;
+   out << '\n';
    for (size_t i = 0; i < _dfsList.size(); i++) {
-      if (_dfsList[i]->_type == PI_GATE)
-      {
-         cout << "[" << i-n << "] ";
-         _dfsList[i]->printGate();
-         cout << endl;
-      }
-      else if (_dfsList[i]->_type == PO_GATE) 
-      {
-         cout << "[" << i-n << "] ";
-         _dfsList[i]->printGate();
-         if (_dfsList[i]->_fanin[0]->_type == UNDEF_GATE) cout << '*';
-         if (_dfsList[i]->_invert[0]) cout << '!';
-         cout << _dfsList[i]->_fanin[0]->_id;
-         if(_dfsList[i]->_name!="") cout << " (" << _dfsList[i]->_name << ")";
-         cout << endl;
-      }
-      else if(_dfsList[i]->_type == AIG_GATE)
-      {
-         cout << "[" << i-n << "] ";
-         _dfsList[i]->printGate();
-         if (_dfsList[i]->_fanin[0]->_type == UNDEF_GATE) cout << '*';
-         if (_dfsList[i]->_invert[0]) cout << '!';
-         cout<< _dfsList[i]->_fanin[0]->_id <<' ';
-         if (_dfsList[i]->_fanin[1]->_type == UNDEF_GATE) cout << '*';
-         if (_dfsList[i]->_invert[1]) cout << '!';
-         cout<< _dfsList[i]->_fanin[1]->_id;
-         cout << endl;
-      }
-      else if(_dfsList[i]->_type == CONST_GATE)
-      {
-         cout << "[" << i-n << "] ";
-         _dfsList[i]->printGate();
-         cout << endl;
-      }
-      else
-      {
-         n++;
+      const CirGate* g = _dfsList[i];
+      if (g->_type == UNDEF_GATE) { n++; continue; }
+      out << '[' << i-n << "] ";
+      g->printGate(out);
+      for (unsigned j = 0; j < g->getFaninNum(); j++) {
+         if (j) out << ' ';
+         if (g->_fanin[j]->_type == UNDEF_GATE) out << '*';
+         if (g->_fanin[j].isInv()) out << '!';
+         out << g->_fanin[j]->_id;
       }
+      if (g->_type == PO_GATE && g->_name) out << " (" << g->_name << ")";
+      out << '\n';
    }
 }
 
@@ -286,20 +504,19 @@ CirMgr::printFloatGates() const
 {
    IdList undef;
    IdList unused;
-   map<unsigned, CirGate*>::const_iterator i, n;
-   for (i = _Gatelist.begin(), n = _Gatelist.end(); i != n; i++) {
-      // if (i->second->_type == NULL)  continue;
-      if (i->second->_type == CONST_GATE) continue;
-      if (i->second->_type != PO_GATE && i->second->_fanout.empty())
+   for (unsigned id = 0, n = _Gatelist.size(); id < n; id++) {
+      const CirGate* g = _Gatelist[id];
+      if (g == 0 || g->_type == CONST_GATE) continue;
+      if (g->_type != PO_GATE && g->_foNum == 0)
       {
-         unused.push_back(i->first);
+         unused.push_back(id);
          continue;
       }
-      for (unsigned j = 0; j < i->second->_fanin.size(); j++)
+      for (unsigned j = 0; j < g->getFaninNum(); j++)
       {
-         if (i->second->_fanin[j]->_type == UNDEF_GATE)
+         if (g->_fanin[j]->_type == UNDEF_GATE)
          {
-            undef.push_back(i->first);
+            undef.push_back(id);
             break;
          }
       }
@@ -320,235 +537,748 @@ CirMgr::printFloatGates() const
    }
 }
 
+// One line per FEC group: "[i] id !id ...", with the IDs ascending in a
+// group and the groups by their smallest ID; "!" marks a gate that is the
+// complement of the first one on the line
+void
+CirMgr::printFECPairs() const
+{
+   vector<IdList> grps(fecGrpNum());
+   for (size_t j = 0; j < grps.size(); j++) {
+      grps[j].assign(_fecList.begin() + _fecGrpBegin[j],
+                     _fecList.begin() + _fecGrpBegin[j+1]);
+      sort(grps[j].begin(), grps[j].end());
+   }
+   sort(grps.begin(), grps.end());
+   for (size_t j = 0; j < grps.size(); j++) {
+      cout << "[" << j << "]";
+      for (size_t k = 0; k < grps[j].size(); k++)
+         cout << ' ' << (((grps[j][k] ^ grps[j][0]) & 1)? "!": "")
+              << grps[j][k] / 2;
+      cout << endl;
+   }
+}
+
+// Print the report of CIRGate -FANIn/-FANOut, built once per gate,
+// direction and level. The cache is dropped as a whole once it holds
+// CONE_CACHE_BYTES.
+void
+CirMgr::reportCone(const CirGate* g, int level, bool fanout) const
+{
+   size_t key = (size_t(level) << 33) | (size_t(g->_id) << 1) | fanout;
+   map<size_t, string>::iterator it = _coneCache.find(key);
+   if (it == _coneCache.end()) {
+      string report;
+      if (!g->writeCone(level, fanout, report, cout, CONE_REPORT_BYTES)) {
+         cout << report << flush;
+         return;
+      }
+      if (_coneCacheBytes > CONE_CACHE_BYTES) {
+         _coneCache.clear();
+         _coneCacheBytes = 0;
+      }
+      _coneCacheBytes += report.size();
+      it = _coneCache.insert(make_pair(key, string())).first;
+      it->second.swap(report);
+   }
+   cout.write(it->second.data(), it->second.size());
+   cout.flush();
+}
+
+// CIRGate -All: the report of every gate in ID order, through one buffer
+void
+CirMgr::reportAllGates() const
+{
+   CirOutBuf out(cout);
+   for (size_t id = 0; id < _Gatelist.size(); id++)
+      if (_Gatelist[id]) _Gatelist[id]->reportGate(out);
+}
+
+/**********************************************************
+Phase          Runs    Time (s)      Allocs  Alloc (MB)
+--------------------------------------------------------
+header            1      0.0000           3        0.00
+...
+--------------------------------------------------------
+Total                    0.0123        1234        1.23
+**********************************************************/
+void
+CirMgr::printProfile() const
+{
+   char line[128];
+   cout << endl;
+   snprintf(line, sizeof(line), "%-12s %6s %11s %11s %11s", "Phase", "Runs",
+            "Time (s)", "Allocs", "Alloc (MB)");
+   cout << line << endl;
+   cout << string(56, '-') << endl;
+   CirPhaseStat total = { "Total", 0, 0, 0, 0 };
+   for (size_t i = 0; i < _phases.size(); i++) {
+      const CirPhaseStat& p = _phases[i];
+      snprintf(line, sizeof(line), "%-12s %6u %11.4f %11zu %11.2f", p._name,
+               p._nRuns, p._time, p._nAllocs, p._allocBytes / double(1 << 20));
+      cout << line << endl;
+      total._time += p._time;
+      total._nAllocs += p._nAllocs;
+      total._allocBytes += p._allocBytes;
+   }
+   cout << string(56, '-') << endl;
+   snprintf(line, sizeof(line), "%-12s %6s %11.4f %11zu %11.2f", total._name,
+            "", total._time, total._nAllocs,
+            total._allocBytes / double(1 << 20));
+   cout << line << endl;
+}
+
+// The same numbers as a JSON object, with the circuit size they belong to
+void
+CirMgr::writeProfile(ostream& os) const
+{
+   char num[32];
+   os << "{\n  \"circuit\": { \"M\": " << M << ", \"PI\": " << _in.size()
+      << ", \"PO\": " << _out.size() << ", \"AIG\": " << _aig.size()
+      << " },\n  \"phases\": [";
+   for (size_t i = 0; i < _phases.size(); i++) {
+      const CirPhaseStat& p = _phases[i];
+      snprintf(num, sizeof(num), "%.6f", p._time);
+      os << (i? ",": "") << "\n    { \"name\": \"" << p._name
+         << "\", \"runs\": " << p._nRuns << ", \"seconds\": " << num
+         << ", \"allocs\": " << p._nAllocs << ", \"allocBytes\": "
+         << p._allocBytes << " }";
+   }
+   os << (_phases.empty()? "": "\n  ") << "]\n}" << endl;
+}
+
 void
 CirMgr::writeAag(ostream& outfile) const
 {
-   int dfs_A=0;
+   CirOutBuf out(outfile);
+   unsigned dfs_A = 0;
    for (size_t i = 0; i < _dfsList.size(); i++)
       if (_dfsList[i]->_type == AIG_GATE) dfs_A++;
-   outfile << "aag "<<M<<" "<<I<<" "<<L<<" "<<O<<" "<<dfs_A<<endl;
-   for (unsigned i = 0; i < I; i++) {
-      outfile << l[i+1];
-      outfile << endl;
-   }
+   out << "aag " << M << ' ' << I << ' ' << L << ' ' << O << ' ' << dfs_A
+       << '\n';
+   // gate lines are regenerated since passes may have changed the fanins
+   for (unsigned i = 0; i < I; i++)
+      out << 2*_in[i]->_id << '\n';
    for (unsigned i = 0; i < O; i++) {
-      outfile << l[i+1+I];
-      outfile << endl;
+      const CirGateV& in = _out[i]->_fanin[0];
+      out << 2*in->_id + in.isInv() << '\n';
    }
    for (size_t i = 0; i < _dfsList.size(); i++) {
-      if (_dfsList[i]->_type != AIG_GATE) continue;
-      outfile << l[(_dfsList[i]->_lineNo)-1];  
-      outfile << endl;
+      const CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE) continue;
+      out << 2*g->_id << ' ' << 2*g->_fanin[0]->_id + g->_fanin[0].isInv()
+          << ' ' << 2*g->_fanin[1]->_id + g->_fanin[1].isInv() << '\n';
    }
-   int comment = I+O+A+1;
-   while (comment < l.size())
-   {
-      if (l[comment] == "c") break;
-      outfile << l[comment];
-      outfile << endl;
-      comment++;
-   }
-   outfile<<"c"<<endl;
-   outfile<<"AAG output by Chung-Yang (Ric) Huang"<<endl;
-   // outfile<<"AAG output by Chien-Ying (Catherine) Yang"<<endl;
+   for (unsigned i = 0; i < I; i++)
+      if (_in[i]->_name) out << 'i' << i << ' ' << _in[i]->_name << '\n';
+   for (unsigned i = 0; i < O; i++)
+      if (_out[i]->_name) out << 'o' << i << ' ' << _out[i]->_name << '\n';
+   out << "c\n";
+   out << "AAG output by Chung-Yang (Ric) Huang\n";
+   // out << "AAG output by Chien-Ying (Catherine) Yang\n";
 }
 
+// Binary AIGER needs the PIs as variables 1..I and the AND gates numbered
+// consecutively in topological order, so the gates in _dfsList are
+// renumbered. Undefined fanins are tied to CONST0.
 void
+CirMgr::writeAig(ostream& outfile) const
+{
+   CirOutBuf out(outfile);
+   vector<unsigned> var(M+O+1, 0);
+   for (unsigned i = 0; i < I; i++)
+      var[_in[i]->_id] = i+1;
+   unsigned dfs_A = 0;
+   for (size_t i = 0; i < _dfsList.size(); i++)
+      if (_dfsList[i]->_type == AIG_GATE) var[_dfsList[i]->_id] = I + ++dfs_A;
+   out << "aig " << I+dfs_A << ' ' << I << ' ' << L << ' ' << O << ' '
+       << dfs_A << '\n';
+   for (unsigned i = 0; i < O; i++)
+      out << 2*var[_out[i]->_fanin[0]->_id] + _out[i]->_fanin[0].isInv()
+          << '\n';
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE) continue;
+      unsigned lit = 2*var[g->_id];
+      unsigned in0 = 2*var[g->_fanin[0]->_id] + g->_fanin[0].isInv();
+      unsigned in1 = 2*var[g->_fanin[1]->_id] + g->_fanin[1].isInv();
+      if (in0 < in1) swap(in0, in1);
+      writeDelta(out, lit - in0);
+      writeDelta(out, in0 - in1);
+   }
+   for (unsigned i = 0; i < I; i++)
+      if (_in[i]->_name) out << 'i' << i << ' ' << _in[i]->_name << '\n';
+   for (unsigned i = 0; i < O; i++)
+      if (_out[i]->_name) out << 'o' << i << ' ' << _out[i]->_name << '\n';
+   out << "c\n";
+   out << "AIG output by Chung-Yang (Ric) Huang\n";
+}
+
+bool
 CirMgr::readHeader()
 {
-   vector<string> header;
-   string::size_type pos1_, pos2_;
-   string d = " ";
-   pos2_ = l[0].find(d);
-   pos1_ = 0;
-   while(string::npos != pos2_)
-   {
-      header.push_back(l[0].substr(pos1_, pos2_-pos1_));
-      pos1_ = pos2_ + d.size();
-      pos2_ = l[0].find(d, pos1_);
-   }
-   if(pos1_ != l[0].length())
-      header.push_back(l[0].substr(pos1_));
-   M = atof(header[1].c_str()); // store in miloa
-   I = atof(header[2].c_str());
-   L = atof(header[3].c_str());
-   O = atof(header[4].c_str());
-   A = atof(header[5].c_str());
+   if (*aagPtr == ' ') return parseError(EXTRA_SPACE);
+   if (isspace((unsigned char)*aagPtr)) {
+      errInt = *aagPtr;
+      return parseError(ILLEGAL_WSPACE);
+   }
+   string ident = peekToken();
+   aigBinary = (ident.compare(0, 3, "aig") == 0);
+   if (ident.size() > 3 && isdigit((unsigned char)ident[3]) &&
+       (aigBinary || ident.compare(0, 3, "aag") == 0)) {
+      colNo = 3;
+      return parseError(MISSING_SPACE);
+   }
+   if (ident != "aag" && ident != "aig") {
+      errMsg = ident;
+      return parseError(ILLEGAL_IDENTIFIER);
+   }
+   aagPtr += 3; colNo = 3;
+   // store in miloa
+   static const char* const numName[5] = {
+      "number of variables", "number of PIs", "number of latches",
+      "number of POs", "number of AIGs"
+   };
+   unsigned* num[5] = { &M, &I, &L, &O, &A };
+   for (int k = 0; k < 5; k++)
+      if (!readSpace(numName[k]) || !readNum(*num[k], numName[k]))
+         return false;
+   if (!checkNewline()) return false;
+   if (M < (unsigned long long)I + L + A) {
+      errMsg = "Number of variables";
+      errInt = M;
+      return parseError(NUM_TOO_SMALL);
+   }
+   if (L != 0) {
+      errMsg = "latches";
+      return parseError(ILLEGAL_NUM);
+   }
+   skipLine();
+   _Gatelist.resize(M+O+1, 0);
    _in.resize(I);
    _out.resize(O);
    _aig.resize(A);
+   _faninLits.resize(O + 2 * A);
+   return true;
 }
 
-void
+// "lit" of a "type" gate was read at column "col"
+bool
+CirMgr::defineGate(unsigned lit, const char* type, unsigned col) const
+{
+   unsigned id = lit/2;
+   unsigned end = colNo;
+   colNo = col;
+   errInt = lit;
+   if (id == 0) return parseError(REDEF_CONST);
+   if (id > M) return parseError(MAX_LIT_ID);
+   if (lit & 1) {
+      errMsg = type;
+      return parseError(CANNOT_INVERTED);
+   }
+   if (_Gatelist[id] != 0) {
+      errGate = _Gatelist[id];
+      return parseError(REDEF_GATE);
+   }
+   colNo = end;
+   return true;
+}
+
+// A fanin literal "lit" was read at column "col"
+bool
+CirMgr::checkFaninLit(unsigned lit, unsigned col) const
+{
+   if (lit/2 <= M) return true;
+   colNo = col;
+   errInt = lit;
+   return parseError(MAX_LIT_ID);
+}
+
+bool
 CirMgr::readInput()
 {
    for (unsigned i = 0; i < I; i++)
    {
-      unsigned id = atof(l[i+1].c_str())/2;
+      unsigned lit = 2*(i+1);
       unsigned lineNo = i+2;
-      _in[i] = new CirPiGate(id, lineNo);
+      if (!aigBinary &&
+          (!checkLine("PI") || !readNum(lit, "PI literal ID")))
+         return false;
+      if (!defineGate(lit, "PI", 0)) return false;
+      if (!aigBinary && !checkNewline()) return false;
+      unsigned id = lit/2;
+      _in[i] = new (_mem) CirPiGate(id, lineNo);
       _Gatelist[id] = _in[i];
+      if (!aigBinary) skipLine();
    }
+   return true;
 }
 
-void
+bool
 CirMgr::readOutput()
 {
    for (unsigned i = 0; i < O; i++)
    {
       unsigned id = M+i+1;
       unsigned lineNo = i+2+I;
-      _out[i] = new CirPoGate(id, lineNo);
+      if (!checkLine("PO") || !readNum(_faninLits[i], "PO literal ID") ||
+          !checkFaninLit(_faninLits[i], 0) || !checkNewline())
+         return false;
+      _out[i] = new (_mem) CirPoGate(id, lineNo);
       _Gatelist[id] = _out[i];
+      skipLine();
    }
+   return true;
 }
 
-void
+bool
 CirMgr::readAig()
 {
-   // AIG_GATE
+   if (_readThreads > 1 && !aigBinary && A >= READ_MT_MIN_GATES &&
+       readAigParallel())
+      return true;
+   // AIG_GATE: parse AIG | INPUT1 | INPUT2; fanins are kept as literals
+   // and wired up in connection() once every gate exists
    for (unsigned i = 0; i < A; i++)
    {
-      vector<string> Aigs; //parse AIG | INPUT1 | INPUT2
-      if (!lexOptions(l[i+1+I+O], Aigs)) return;
-      unsigned id = atof(Aigs[0].c_str())/2;
+      unsigned lit = 0;
+      unsigned& in0 = _faninLits[O+2*i];
+      unsigned& in1 = _faninLits[O+2*i+1];
+      if (aigBinary) {
+         // lhs = 2(I+L+i+1), in0 = lhs - delta0, in1 = in0 - delta1
+         unsigned delta0 = 0, delta1 = 0;
+         if (!readDelta(delta0) || !readDelta(delta1)) {
+            errMsg = "AIG";
+            return parseError(MISSING_DEF);
+         }
+         lit = 2*(I+L+i+1);
+         in0 = lit - delta0;
+         in1 = in0 - delta1;
+         if (!defineGate(lit, "AIG gate", 0)) return false;
+      }
+      else {
+         if (!checkLine("AIG") || !readNum(lit, "AIG gate literal ID") ||
+             !defineGate(lit, "AIG gate", 0))
+            return false;
+         for (int k = 0; k < 2; k++) {
+            unsigned& in = k? in1: in0;
+            if (!readSpace()) return false;
+            unsigned col = colNo;
+            if (!readNum(in, "AIG input literal ID") ||
+                !checkFaninLit(in, col))
+               return false;
+         }
+         if (!checkNewline()) return false;
+      }
+      unsigned id = lit/2;
       unsigned lineNo = i+2+I+O;
-      _aig[i] = new CirAigGate(id, lineNo);
+      _aig[i] = new (_mem) CirAigGate(id, lineNo);
       _Gatelist[id] = _aig[i];
+      if (!aigBinary) skipLine();
    }
+   return true;
 }
 
+// The AND section is cut into _readThreads byte ranges at line boundaries.
+// The threads count the lines of their ranges, which numbers the ranges,
+// and then decode them and create their gates in one slab.
+// Return false, with no gate defined, if some line is not in the plain
+// form or a gate is redefined; readAig() then parses the section again
+// sequentially and reports the error.
+bool
+CirMgr::readAigParallel()
+{
+   unsigned nThreads = _readThreads;
+   // the AND section cannot be longer than A lines of 3 maximal literals
+   size_t maxLine = 3 * uintStr(2*M+1).size() + 3;
+   const char* end = aagEnd;
+   if (size_t(aagEnd - aagPtr) > A * maxLine) end = aagPtr + A * maxLine;
+   vector<CirAndChunk> chunks(nThreads);
+   for (unsigned t = 0; t < nThreads; t++) {
+      const char* begin = aagPtr + (end - aagPtr) * t / nThreads;
+      if (t) {
+         begin = (const char*)memchr(begin - 1, '\n', end - begin + 1);
+         begin = begin? begin + 1: end;
+      }
+      chunks[t]._begin = begin;
+      chunks[t]._next = 0;
+      if (t) chunks[t-1]._end = begin;
+   }
+   chunks[nThreads-1]._end = end;
+   vector<thread> workers;
+   for (unsigned t = 1; t < nThreads; t++)
+      workers.push_back(thread(countChunkLines, &chunks[t]));
+   countChunkLines(&chunks[0]);
+   for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+   size_t nLines = 0;
+   for (unsigned t = 0; t < nThreads; t++) {
+      chunks[t]._first = nLines;
+      nLines += chunks[t]._nLines;
+   }
+   if (nLines < A) return false;
+
+   CirAigGate* slab = (CirAigGate*)_mem.alloc(sizeof(CirAigGate) * A);
+   atomic<bool> bad(false);
+   workers.clear();
+   for (unsigned t = 1; t < nThreads; t++)
+      workers.push_back(thread(&CirMgr::defineAigChunk, this, &chunks[t],
+                               slab, &bad));
+   defineAigChunk(&chunks[0], slab, &bad);
+   for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+   if (bad) {
+      for (unsigned i = 0; i < A; i++) {
+         if (!_aig[i]) continue;
+         unsigned id = _aig[i]->_id;
+         if (id <= M && _Gatelist[id] == _aig[i]) _Gatelist[id] = 0;
+         _aig[i] = 0;
+      }
+      return false;
+   }
+   // leave the cursor past the section as the sequential parser would
+   for (unsigned t = 0; t < nThreads; t++)
+      if (chunks[t]._next) aagPtr = chunks[t]._next;
+   lineNo += A; colNo = 0;
+   return true;
+}
+
+// Decode the lines of "c" that are in the AND section and create their
+// gates; set "bad" if a line is not in the plain form, a literal is out of
+// range, or a gate is inverted or defined twice
 void
+CirMgr::defineAigChunk(CirAndChunk* c, CirAigGate* slab, atomic<bool>* bad)
+{
+   const char* p = c->_begin;
+   const char* eol = 0;
+   unsigned lits[3];
+   for (size_t i = c->_first; i < A && p < c->_end; i++) {
+      if (!decodeAndLine(p, c->_end, lits, eol)) { *bad = true; return; }
+      unsigned id = lits[0]/2;
+      CirAigGate* g = ::new (slab + i) CirAigGate(id, i+2+I+O);
+      _aig[i] = g;
+      _faninLits[O+2*i] = lits[1];
+      _faninLits[O+2*i+1] = lits[2];
+      if (id == 0 || id > M || (lits[0] & 1) || lits[1]/2 > M ||
+          lits[2]/2 > M ||
+          !__sync_bool_compare_and_swap(&_Gatelist[id], (CirGate*)0, g)) {
+         *bad = true;
+         return;
+      }
+      if (i == A - 1) c->_next = p;
+   }
+}
+
+// Symbol lines "i<index> <name>" and "o<index> <name>", up to a "c" line
+// that starts the comment. A last line with no newline is ignored.
+bool
 CirMgr::readComment()
 {
-   int nameLine = I+O+A+1;
-   while (nameLine < l.size())
+   while (!atEOF())
    {
-      if (l[nameLine] == "c") break;
-      vector<string> newName;
-      if (!lexOptions(l[nameLine], newName)) return ;
-      if (l[nameLine][0] == 'i') {
-         int index;
-         string s = newName[0];
-         stringstream ss(s);
-         ss.ignore(1);
-         ss >> index;
-         _in[index]->_name = newName[1];
+      const char* eol = (const char*)memchr(aagPtr, '\n', aagEnd - aagPtr);
+      if (!eol) break;
+      char type = *aagPtr;
+      if (type == 'c') {
+         ++aagPtr; ++colNo;
+         if (aagPtr != eol) return parseError(MISSING_NEWLINE);
+         break;
+      }
+      if (type == ' ') return parseError(EXTRA_SPACE);
+      if (type != '\n' && isspace((unsigned char)type)) {
+         errInt = type;
+         return parseError(ILLEGAL_WSPACE);
+      }
+      if (type != 'i' && type != 'o') {
+         errMsg = (type == '\n')? string(): string(1, type);
+         return parseError(ILLEGAL_SYMBOL_TYPE);
       }
-      else if (l[nameLine][0] == 'o') {
-         int index;
-         string s = newName[0];
-         stringstream ss(s);
-         ss.ignore(1);
-         ss >> index;
-         _out[index]->_name = newName[1];
+      GateList& ports = (type == 'i')? _in: _out;
+      unsigned index = 0;
+      ++aagPtr; ++colNo;
+      if (!readNum(index, "symbol index")) return false;
+      if (index >= ports.size()) {
+         errMsg = (type == 'i')? "PI index": "PO index";
+         errInt = index;
+         return parseError(NUM_TOO_BIG);
       }
-      nameLine++;
+      errMsg = "symbolic name";
+      if (aagPtr == eol) return parseError(MISSING_IDENTIFIER);
+      if (*aagPtr != ' ') return parseError(MISSING_SPACE);
+      ++aagPtr; ++colNo;
+      if (aagPtr == eol) return parseError(MISSING_IDENTIFIER);
+      for (const char* p = aagPtr; p < eol; ++p, ++colNo)
+         if (!isprint((unsigned char)*p)) {
+            errInt = (unsigned char)*p;
+            return parseError(ILLEGAL_SYMBOL_NAME);
+         }
+      if (ports[index]->_name) {
+         errMsg = string(1, type);
+         errInt = index;
+         return parseError(REDEF_SYMBOLIC_NAME);
+      }
+      ports[index]->_name = _mem.allocStr(aagPtr, eol);
+      skipLine();
+   }
+   return true;
+}
+
+// return 0 if "lit" exceeds the maximum ID
+CirGate*
+CirMgr::litGate(unsigned lit)
+{
+   unsigned id = lit/2;
+   if (id > M) {
+      errInt = lit;
+      parseError(MAX_LIT_ID);
+      return 0;
    }
+   if (_Gatelist[id] == 0) _Gatelist[id] = new (_mem) CirUndefGate(id);
+   return _Gatelist[id];
 }
 
-void
+bool
 CirMgr::connection()
 {
-   // DEAL WITH AIG_GATE's FAN_IN FAN_OUT
-   for (unsigned i = 0; i < A; i++) {
-      // parse _aig[i] | INPUT1 | INPUT2
-      // Aigs    [0]      [1]      [2]
-      vector<string> Aigs; 
-      if (!lexOptions(l[i+1+I+O], Aigs)) return;
-      unsigned aigid = atof(Aigs[0].c_str())/2;
-      for (int count = 1; count != 3; count++) {
-         if ((int)atof(Aigs[count].c_str()) % 2 != 0)
-         { // invert
-            unsigned id = (atof(Aigs[count].c_str())-1)/2;
-            map<unsigned, CirGate*>::iterator it = _Gatelist.find(id);
-            if (it == _Gatelist.end())
-               _Gatelist[id] = new CirUndefGate(id);
-            _Gatelist[aigid]->_fanin.push_back(_Gatelist[id]);
-            _Gatelist[aigid]->_invert.push_back(true);
-            _Gatelist[id]->_fanout.push_back(_Gatelist[aigid]);
-            _Gatelist[id]->_outinvert.push_back(true);
-         }
-         else
-         {
-            unsigned id = atof(Aigs[count].c_str())/2;
-            map<unsigned, CirGate*>::iterator it = _Gatelist.find(id);
-            if (it == _Gatelist.end())
-               _Gatelist[id] = new CirUndefGate(id);
-            _Gatelist[aigid]->_fanin.push_back(_Gatelist[id]);
-            _Gatelist[aigid]->_invert.push_back(false);
-            _Gatelist[id]->_fanout.push_back(_Gatelist[aigid]);
-            _Gatelist[id]->_outinvert.push_back(false);
-         }
+   // DEAL WITH AIG_GATE's FAN_IN
+   bool aigDone = _readThreads > 1 && A >= READ_MT_MIN_GATES &&
+                  connectAigParallel();
+   for (unsigned i = 0; !aigDone && i < A; i++) {
+      CirGate* aig = _aig[i];
+      for (int count = 0; count != 2; count++) {
+         unsigned lit = _faninLits[O+2*i+count];
+         CirGate* fanin = litGate(lit);
+         if (!fanin) return false;
+         aig->_fanin[count] = CirGateV(fanin, lit & 1);
       }
    }
    // DEAL WITH PO's FANIN
    for (unsigned i = 0; i < O; i++) {
-      unsigned outid = M+i+1;
-      if ((int)atof(l[i+1+I].c_str()) % 2 != 0)
-      {  // invert
-         unsigned id = (atof(l[i+1+I].c_str())-1)/2;
-         map<unsigned, CirGate*>::iterator it = _Gatelist.find(id);
-         if (it == _Gatelist.end())
-            _Gatelist[id] = new CirUndefGate(id);
-         _Gatelist[outid]->_fanin.push_back(_Gatelist[id]);
-         _Gatelist[outid]->_invert.push_back(true);
-         _Gatelist[id]->_fanout.push_back(_Gatelist[outid]);
-         _Gatelist[id]->_outinvert.push_back(true);
+      unsigned lit = _faninLits[i];
+      CirGate* fanin = litGate(lit);
+      if (!fanin) return false;
+      _out[i]->_fanin[0] = CirGateV(fanin, lit & 1);
+   }
+   clearList(_faninLits);
+   buildFanout(A >= READ_MT_MIN_GATES? _readThreads: 1);
+   return true;
+}
+
+// Wire the AIG fanins on _readThreads threads, each taking a range of
+// _aig. A fanin that is not defined is created as an UNDEF gate afterwards,
+// in AIG order. Return false if a literal exceeds the maximum ID; the
+// sequential loop then redoes the wiring and reports it.
+bool
+CirMgr::connectAigParallel()
+{
+   unsigned nThreads = _readThreads;
+   vector<IdList> undef(nThreads);   // 2 * index in _aig + fanin
+   atomic<bool> bad(false);
+   vector<thread> workers;
+   for (unsigned t = 1; t < nThreads; t++)
+      workers.push_back(thread(&CirMgr::connectAigRange, this,
+                               size_t(A) * t / nThreads,
+                               size_t(A) * (t+1) / nThreads, &undef[t], &bad));
+   connectAigRange(0, A / nThreads, &undef[0], &bad);
+   for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+   if (bad) return false;
+   for (unsigned t = 0; t < nThreads; t++)
+      for (size_t k = 0; k < undef[t].size(); k++) {
+         unsigned i = undef[t][k] / 2, j = undef[t][k] & 1;
+         unsigned lit = _faninLits[O+2*i+j];
+         _aig[i]->_fanin[j] = CirGateV(litGate(lit), lit & 1);
       }
-      else
-      {
-         unsigned id = atof(l[i+1+I].c_str())/2;
-         map<unsigned, CirGate*>::iterator it = _Gatelist.find(id);
-         if (it == _Gatelist.end())
-            _Gatelist[id] = new CirUndefGate(id);
-         _Gatelist[outid]->_fanin.push_back(_Gatelist[id]);
-         _Gatelist[outid]->_invert.push_back(false);
-         _Gatelist[id]->_fanout.push_back(_Gatelist[outid]);
-         _Gatelist[id]->_outinvert.push_back(false);
+   return true;
+}
+
+void
+CirMgr::connectAigRange(size_t from, size_t to, IdList* undef,
+                        atomic<bool>* bad)
+{
+   for (size_t i = from; i < to; i++)
+      for (unsigned j = 0; j < 2; j++) {
+         unsigned lit = _faninLits[O+2*i+j];
+         if (lit/2 > M) { *bad = true; return; }
+         CirGate* fanin = _Gatelist[lit/2];
+         if (fanin) _aig[i]->_fanin[j] = CirGateV(fanin, lit & 1);
+         else undef->push_back(2*i+j);
       }
+}
+
+// All fanouts live in _fanoutPool; each gate owns the slice
+// [_fanout, _fanout + _foNum). Fanouts are listed in the order of the
+// AIG definitions followed by the POs.
+// With nThreads > 1, the AIGs are split among threads that count and place
+// their fanout edges with atomic increments; the slices are then sorted back
+// into AIG order by line number, which follows _aig as long as no pass has
+// reordered the gates, i.e. right after parsing.
+void
+CirMgr::buildFanout(unsigned nThreads)
+{
+   _coneCache.clear();
+   _coneCacheBytes = 0;
+   for (size_t i = 0; i < _Gatelist.size(); i++)
+      if (_Gatelist[i]) _Gatelist[i]->_foNum = 0;
+   runFanoutPhase(&CirMgr::countFanoutRange, _aig.size(), nThreads);
+   size_t nEdges = 2 * _aig.size() + _out.size();
+   for (size_t i = 0; i < _out.size(); i++)
+      _out[i]->_fanin[0]->_foNum++;
+   _fanoutPool.resize(nEdges);
+   CirGateV* edge = nEdges? &_fanoutPool[0]: 0;
+   for (size_t i = 0; i < _Gatelist.size(); i++) {
+      CirGate* g = _Gatelist[i];
+      if (!g) continue;
+      g->_fanout = edge;
+      edge += g->_foNum;
+      g->_foNum = 0;
+   }
+   runFanoutPhase(&CirMgr::fillFanoutRange, _aig.size(), nThreads);
+   if (nThreads > 1)
+      runFanoutPhase(&CirMgr::sortFanoutRange, _Gatelist.size(), nThreads);
+   for (size_t i = 0; i < _out.size(); i++) {
+      CirGateV in = _out[i]->_fanin[0];
+      in->_fanout[in->_foNum++] = CirGateV(_out[i], in.isInv());
    }
 }
 
-bool
-CirMgr::lexOptions(const string& option, vector<string>& tokens) const
+// Run "phase" over [0, n) split among nThreads threads
+void
+CirMgr::runFanoutPhase(void (CirMgr::*phase)(size_t, size_t, bool),
+                       size_t n, unsigned nThreads)
+{
+   bool shared = nThreads > 1;
+   vector<thread> workers;
+   for (unsigned t = 1; t < nThreads; t++)
+      workers.push_back(thread(phase, this, n * t / nThreads,
+                               n * (t+1) / nThreads, shared));
+   (this->*phase)(0, n / nThreads, shared);
+   for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+void
+CirMgr::countFanoutRange(size_t from, size_t to, bool shared)
 {
-   string token;
-   size_t n = myStrGetTok(option, token);
-   while (token.size()) {
-      tokens.push_back(token);
-      n = myStrGetTok(option, token, n);
+   for (size_t i = from; i < to; i++)
+      for (int j = 0; j < 2; j++) {
+         CirGate* in = _aig[i]->_fanin[j].gate();
+         if (shared) __sync_fetch_and_add(&in->_foNum, 1);
+         else in->_foNum++;
+      }
+}
+
+void
+CirMgr::fillFanoutRange(size_t from, size_t to, bool shared)
+{
+   for (size_t i = from; i < to; i++)
+      for (int j = 0; j < 2; j++) {
+         CirGateV in = _aig[i]->_fanin[j];
+         unsigned k = shared? __sync_fetch_and_add(&in->_foNum, 1):
+                              in->_foNum++;
+         in->_fanout[k] = CirGateV(_aig[i], in.isInv());
+      }
+}
+
+// Insertion-sort the fanouts of _Gatelist[from, to) by line number
+void
+CirMgr::sortFanoutRange(size_t from, size_t to, bool)
+{
+   for (size_t id = from; id < to; id++) {
+      CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      CirGateV* fo = g->_fanout;
+      for (unsigned k = 1; k < g->_foNum; k++) {
+         CirGateV v = fo[k];
+         unsigned m = k;
+         for (; m && fo[m-1]->_lineNo > v->_lineNo; m--) fo[m] = fo[m-1];
+         fo[m] = v;
+      }
    }
-   return true;
 }
 
 void
 CirMgr::DFS()
-{          
-   _globalRef = 0;
-   _globalRef++;
-   for (unsigned i = 0; i < _out.size(); i++)
-      DFSVisit(_out[i]->_id);
+{
+   _dfsList.clear();
+   dfsOrder(_out, _dfsList);
+   levelise();
 }
 
+// Compute the gate levels along _dfsList and counting-sort the list into
+// _levelList
 void
-CirMgr::DFSVisit(unsigned vertex)
+CirMgr::levelise()
 {
-   if (_Gatelist[vertex]->_fanin.size() > 0) {
-      for (size_t i = 0; i < _Gatelist[vertex]->_fanin.size(); i++) {
-         if(_Gatelist[vertex]->_fanin[i]->_ref != _globalRef) {
-            _Gatelist[vertex]->_fanin[i]->_ref = _globalRef;
-            DFSVisit(_Gatelist[vertex]->_fanin[i]->_id);
+   IdList levelCount(1, 0);
+   _depth = 0;
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      CirGate* g = _dfsList[i];
+      unsigned lv = 0;
+      for (unsigned j = 0; j < g->getFaninNum(); j++)
+         lv = max(lv, g->_fanin[j]->_level + 1);
+      g->_level = lv;
+      if (lv >= levelCount.size()) levelCount.resize(lv + 1, 0);
+      levelCount[lv]++;
+      if (g->_type == AIG_GATE && lv > _depth) _depth = lv;
+   }
+   _levelStart.assign(levelCount.size() + 1, 0);
+   for (size_t lv = 0; lv < levelCount.size(); lv++)
+      _levelStart[lv+1] = _levelStart[lv] + levelCount[lv];
+   IdList fill(_levelStart.begin(), _levelStart.end() - 1);
+   _levelList.resize(_dfsList.size());
+   for (size_t i = 0; i < _dfsList.size(); i++)
+      _levelList[fill[_dfsList[i]->_level]++] = _dfsList[i];
+}
+
+// Post-order DFS from "roots" with an explicit stack, so the depth of the
+// circuit is not limited by the call stack. A gate is appended to "order"
+// after all of its fanins; gates already visited in this call are skipped.
+void
+CirMgr::dfsOrder(const GateList& roots, GateList& order)
+{
+   ++_globalRef;
+   vector<pair<CirGate*, unsigned> > dfsStack;
+   for (size_t r = 0; r < roots.size(); r++) {
+      if (roots[r]->_ref == _globalRef) continue;
+      roots[r]->_ref = _globalRef;
+      dfsStack.push_back(make_pair(roots[r], 0u));
+      while (!dfsStack.empty()) {
+         CirGate* g = dfsStack.back().first;
+         unsigned i = dfsStack.back().second;
+         if (i < g->getFaninNum()) {
+            dfsStack.back().second++;
+            CirGate* fanin = g->_fanin[i].gate();
+            if (fanin->_ref != _globalRef) {
+               fanin->_ref = _globalRef;
+               dfsStack.push_back(make_pair(fanin, 0u));
+            }
+         }
+         else {
+            order.push_back(g);
+            dfsStack.pop_back();
          }
       }
    }
-   // bool exist = false;
-   // for(int i=0;i < _dfsList.size();i++) {
-   //    if(_Gatelist[vertex]->_id == _dfsList[i]->_id) {
-   //       exist = true;
-   //       break;
-   //    }
-   // }
-   // if(exist==false) _dfsList.push_back(_Gatelist[vertex]);
-   _dfsList.push_back(_Gatelist[vertex]);
-}
\ No newline at end of file
+}
+
+CirPhaseMark
+CirMgr::phaseMark() const
+{
+   CirPhaseMark mark = { getWallTime(), getAllocCount(), getAllocBytes() };
+   return mark;
+}
+
+void
+CirMgr::endPhase(const char* name, CirPhaseMark& mark) const
+{
+   size_t i = 0;
+   while (i < _phases.size() && strcmp(_phases[i]._name, name) != 0) ++i;
+   if (i == _phases.size()) {
+      CirPhaseStat p = { name, 0, 0, 0, 0 };
+      _phases.push_back(p);
+   }
+   CirPhaseMark now = phaseMark();
+   CirPhaseStat& p = _phases[i];
+   ++p._nRuns;
+   p._time += now._time - mark._time;
+   p._nAllocs += now._nAllocs - mark._nAllocs;
+   p._allocBytes += now._allocBytes - mark._allocBytes;
+   mark = now;
+}
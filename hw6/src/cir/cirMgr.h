@@ -14,34 +14,67 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <atomic>
 
 using namespace std;
 
 #include "cirDef.h"
+#include "cirGate.h"
 
 extern CirMgr *cirMgr;
 
+// Each gate holds _simWords words; bit k of word w is its output under the
+// (64w + k)-th pattern of the pass. _simWords is 1, 4 (AVX2) or 8 (AVX-512).
+#define SIM_WORD_BITS   64
+// _fecGrpOf[id] of a gate that is in no FEC group
+#define FEC_NONE        unsigned(-1)
+// CIRPrint -Summary prints the level histogram in at most this many rows
+#define SUMMARY_LEVEL_ROWS  16
+// Bytes of cached cone reports kept before the cache is dropped
+#define CONE_CACHE_BYTES  (size_t(64) << 20)
+// A cone report longer than this is printed in pieces and not cached
+#define CONE_REPORT_BYTES (size_t(4) << 20)
+
+// for CIRStat -Profile: the wall time and heap allocation counters
+// (getAllocCount(), getAllocBytes()) when a phase starts
+struct CirPhaseMark
+{
+   double   _time;
+   size_t   _nAllocs, _allocBytes;
+};
+
+// ... and what the runs of one phase took altogether
+struct CirPhaseStat
+{
+   const char* _name;
+   unsigned    _nRuns;
+   double      _time;
+   size_t      _nAllocs, _allocBytes;
+};
+
+class CirSimPool;
+struct CirAndChunk;
+struct CirRwCut;
+struct CirRwData;
+
 // TODO: Define your own data members and member functions
 class CirMgr
 {
 public:
-   CirMgr(){}
-   ~CirMgr() {
-      for(size_t i=0;i!=_Gatelist.size();i++) {
-         delete _Gatelist[i];
-      }
-   }
+   CirMgr(): _readThreads(1), _coneCacheBytes(0), _globalRef(0),
+             _depth(0), _nLevelUpdates(0), _nCycleVisits(0), _simLog(0),
+             _simWords(1), _simKernel(-1), _simThreads(1), _simPool(0) {}
+   ~CirMgr();
 
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
-   CirGate* getGate(unsigned gid) const { 
-      map<unsigned, CirGate*>::const_iterator it = _Gatelist.find(gid);
-      if (it == _Gatelist.end()) return 0;
-      return it->second;
+   CirGate* getGate(unsigned gid) const {
+      return gid < _Gatelist.size()? _Gatelist[gid]: 0;
    }
 
    // Member functions about circuit construction
-   bool readCircuit(const string&);
+   bool readCircuit(const string&, unsigned nThreads = 1);
+   bool readSnapshot(const string&);
 
    // Member functions about circuit reporting
    void printSummary() const;
@@ -49,7 +82,44 @@ public:
    void printPIs() const;
    void printPOs() const;
    void printFloatGates() const;
+   void printFECPairs() const;
+   void reportCone(const CirGate* g, int level, bool fanout) const;
+   void reportAllGates() const;
+   void printProfile() const;
+   void writeProfile(ostream&) const;
    void writeAag(ostream&) const;
+   void writeAig(ostream&) const;
+   void writeSnapshot(ostream&) const;
+
+   // Member functions about circuit optimization
+   void sweep();
+   void optimize();
+   void strash();
+   void fraig();
+   void rewrite();
+
+   // Member functions about technology mapping
+   void lutMap(unsigned k, ostream* blif, const string& model) const;
+
+   // Member functions about incremental editing
+   void benchEdit(unsigned nEdits);
+
+   // Member functions about circuit simulation
+   void randomSim();
+   void fileSim(ifstream&);
+   void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   void setSimThreads(unsigned n) { _simThreads = n? n: 1; }
+   void benchSim();
+
+   // for simulation: one AND of two (possibly inverted) fanin words;
+   // offsets are gate ID * _simWords
+   struct SimNode {
+      unsigned _out, _in0, _in1;
+      size_t   _inv0, _inv1;
+   };
+
+   // Topological (post-order) traversal from "roots"
+   void dfsOrder(const GateList& roots, GateList& order);
 
 private:
    // M, maximum index
@@ -58,26 +128,133 @@ private:
    // O, #outputs
    // A, #AND gates
    unsigned M,I,L,O,A;
-   vector<string> l;
+   CirMemMgr _mem;         // gates and their names; must outlive _Gatelist
+   IdList _faninLits;      // PO/AIG fanin literals, only kept during parsing
+   unsigned _readThreads;  // of the current readCircuit()
    GateList _in;
    GateList _out;
    GateList _aig;
-   map<unsigned, CirGate*> _Gatelist;
+   GateList _Gatelist;     // indexed by gate ID, sized M+O+1
    GateList _dfsList;
+   vector<CirGateV> _fanoutPool;
+   // CIRGate -FANIn/-FANOut reports by gate, direction and level; emptied whenever the
+   // fanouts are rebuilt, i.e. whenever the circuit changes
+   mutable map<size_t, string> _coneCache;
+   mutable size_t   _coneCacheBytes;
    
    // for DFS
    unsigned _globalRef;
    void DFS();
-   void DFSVisit(unsigned vertex);
+
+   // _dfsList bucketed by level, DFS order kept within a level: level l is
+   // [_levelStart[l], _levelStart[l+1]) of _levelList
+   unsigned _depth;        // max AIG level
+   IdList   _levelStart;
+   GateList _levelList;
+   void levelise();
+
+   // for incremental edits; see cirEdit.cpp. From beginEdits() on, fanouts
+   // and the levels of all gates (a topological order) are kept exact
+   // after every edit; _aig, _dfsList and what is derived from it are only
+   // rebuilt by commitEdits(). New gates get IDs past the POs until then.
+   GateList _editAdded;
+   GateList _editRemoved;  // freed by commitEdits()
+   size_t   _nLevelUpdates, _nCycleVisits;
+   void beginEdits();
+   void commitEdits();
+   CirGate* addAig(const CirGateV& in0, const CirGateV& in1);
+   bool setFanin(CirGate* g, unsigned i, const CirGateV& in);
+   void removeAig(CirGate* g);
+   void addFanout(CirGate* in, const CirGateV& out);
+   void removeFanout(CirGate* in, const CirGateV& out);
+   bool inFanoutPool(const CirGate* g) const;
+   bool reaches(CirGate* from, const CirGate* to);
+   void updateLevels(CirGate* g);
+
+   // for CIRStat -Profile: the phases of readCircuit() and the passes, in
+   // the order they first ran. endPhase() charges what happened since
+   // "mark" to phase "name" and moves "mark" to now.
+   mutable vector<CirPhaseStat> _phases;
+   CirPhaseMark phaseMark() const;
+   void endPhase(const char* name, CirPhaseMark& mark) const;
+
+   ofstream*        _simLog;
+   unsigned         _simWords;   // words per gate in _simValue
+   int              _simKernel;  // forced kernel index; -1: widest supported
+   vector<size_t>   _simValue;   // gate ID * _simWords + word
+   vector<SimNode>  _simList;    // AIGs and POs sorted by level
+   IdList           _simLevelStart;
+   unsigned         _simThreads;
+   CirSimPool*      _simPool;    // 0: single-threaded
+   void buildSimList(bool forceThreads = false);
+   void deleteSimPool();
+   void simulate(const vector<size_t>& piWords);
+   void writeSimLog(unsigned nBits) const;
+   void randomPatterns(vector<size_t>& piWords) const;
+
+   // for FRAIG: candidate classes of functionally equivalent gates (CONST0
+   // and AIGs), stored back to back in _fecList; class j is
+   // [_fecGrpBegin[j], _fecGrpBegin[j+1]). An entry is 2 * ID + the first
+   // simulated bit of the gate, so two members are complements if these
+   // bits differ. Each class is in DFS order, and a gate is only merged
+   // into the first member of its class. No classes have been formed
+   // while _fecGrpBegin is empty.
+   IdList           _fecList;
+   IdList           _fecGrpBegin;
+   IdList           _fecGrpOf;   // gate ID -> class or FEC_NONE
+   size_t fecGrpNum() const {
+      return _fecGrpBegin.empty()? 0: _fecGrpBegin.size() - 1;
+   }
+   void initFecGrps();
+   void refineFecGrps();
+   void clearFecGrps();
 
    // Helper function
-   void readHeader();
-   void readInput();
-   void readOutput();
-   void readAig();
-   void readComment();
-   void connection();
-   bool lexOptions(const string& option, vector<string>& tokens) const;
+   bool readHeader();
+   bool readInput();
+   bool readOutput();
+   bool readAig();
+   bool readAigParallel();
+   void defineAigChunk(CirAndChunk* c, CirAigGate* slab, atomic<bool>* bad);
+   bool readComment();
+   bool connection();
+   bool connectAigParallel();
+   void connectAigRange(size_t from, size_t to, IdList* undef,
+                        atomic<bool>* bad);
+   bool loadSnapshot(const char* base, size_t size, const string& fileName);
+   bool snapList(const unsigned* ids, unsigned n, GateType type,
+                 GateList& list) const;
+   bool snapFanoutsMatch() const;
+   bool snapTopoOrder();
+   bool defineGate(unsigned lit, const char* type, unsigned col) const;
+   bool checkFaninLit(unsigned lit, unsigned col) const;
+   CirGate* litGate(unsigned lit);
+   void buildFanout(unsigned nThreads = 1);
+   void runFanoutPhase(void (CirMgr::*phase)(size_t, size_t, bool),
+                       size_t n, unsigned nThreads);
+   void countFanoutRange(size_t from, size_t to, bool shared);
+   void fillFanoutRange(size_t from, size_t to, bool shared);
+   void sortFanoutRange(size_t from, size_t to, bool);
+   void replaceFanin(CirGate* g, const vector<CirGateV>& repl) const;
+   void applyReplace(const vector<CirGateV>& repl);
+   CirGateV foldGate(const CirGate* g) const;
+   CirGateV foldAnd(const CirGateV& in0, const CirGateV& in1) const;
+   unsigned sweepUnreachable();
+   void blifNames(vector<string>& names) const;
+
+   // for CIRRewrite; see cirRewrite.cpp
+   CirGateV rwResolve(const CirRwData& d, CirGateV v) const;
+   void rwComputeCuts(CirRwData& d, CirGate* g);
+   void rwDone(CirRwData& d, CirGate* f);
+   unsigned rwDeref(CirRwData& d, CirGate* g);
+   void rwRef(CirRwData& d, CirGate* g);
+   unsigned rwRevive(CirRwData& d, CirGate* g);
+   int rwGain(CirRwData& d, CirGate* g, const CirRwCut& cut);
+   bool rwBuild(CirRwData& d, CirGate* root, const CirRwCut& cut,
+                unsigned* cost, CirGateV& out);
+   CirGate* rwNewGate(CirRwData& d, const CirGateV& a, const CirGateV& b);
+   void rwReplace(CirRwData& d, CirGate* g, const CirGateV& r);
+   void rwFinish(CirRwData& d);
 };
 
 #endif // CIR_MGR_H
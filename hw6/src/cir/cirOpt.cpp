@@ -0,0 +1,137 @@
+/****************************************************************************
+  FileName     [ cirOpt.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir optimization functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <queue>
+#include <functional>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+
+/**************************************************/
+/*   Public member functions about optimization   */
+/**************************************************/
+// Remove the AIG and UNDEF gates that cannot be reached from any PO
+// (the "defined but not used" gates and whatever only they use)
+void
+CirMgr::sweep()
+{
+   CirPhaseMark mark = phaseMark();
+   cout << "Sweeping: " << sweepUnreachable() << " gate(s) removed." << endl;
+   endPhase("sweep", mark);
+}
+
+// Fold AIG gates with a constant fanin, two identical fanins or two
+// complementary fanins, then sweep what became unreachable.
+// Only the gates whose fanins changed are (re-)examined: a gate is queued
+// when it is a trivial candidate to begin with or when one of its fanins
+// gets replaced. The queue is ordered by position in _dfsList, so a
+// replacement is always final by the time its fanouts are examined.
+void
+CirMgr::optimize()
+{
+   CirPhaseMark mark = phaseMark();
+   double start = getWallTime();
+   vector<CirGateV> repl(_Gatelist.size());
+   IdList dfsPos(_Gatelist.size(), 0);
+   vector<bool> queued(_dfsList.size(), false);
+   priority_queue<unsigned, vector<unsigned>, greater<unsigned> > work;
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      const CirGate* g = _dfsList[i];
+      dfsPos[g->_id] = i;
+      if (g->_type != AIG_GATE) continue;
+      if (g->_fanin[0]->_type == CONST_GATE ||
+          g->_fanin[1]->_type == CONST_GATE ||
+          g->_fanin[0].gate() == g->_fanin[1].gate()) {
+         queued[i] = true;
+         work.push(i);
+      }
+   }
+
+   unsigned nFolded = 0;
+   while (!work.empty()) {
+      CirGate* g = _dfsList[work.top()];
+      work.pop();
+      if (g->_type != AIG_GATE) continue;
+      replaceFanin(g, repl);
+      CirGateV r = foldGate(g);
+      if (!r.gate()) continue;
+      repl[g->_id] = r;
+      ++nFolded;
+      for (unsigned j = 0; j < g->_foNum; j++) {
+         unsigned pos = dfsPos[g->_fanout[j]->_id];
+         if (_dfsList[pos] != g->_fanout[j].gate() || queued[pos]) continue;
+         queued[pos] = true;
+         work.push(pos);
+      }
+   }
+   applyReplace(repl);
+   unsigned nSwept = sweepUnreachable();
+   cout << "Optimizing: " << nFolded << " AIG gate(s) simplified, "
+        << nSwept << " gate(s) swept in " << setprecision(4)
+        << getWallTime() - start << " seconds." << endl;
+   endPhase("optimize", mark);
+}
+
+/***************************************************/
+/*   Private member functions about optimization   */
+/***************************************************/
+// Return what the AIG "g" simplifies to, or a null literal if it does not
+//   CONST0 & x = CONST0,  CONST1 & x = x,  x & x = x,  x & !x = CONST0
+CirGateV
+CirMgr::foldGate(const CirGate* g) const
+{
+   return foldAnd(g->_fanin[0], g->_fanin[1]);
+}
+
+// The same for the AND of "in0" and "in1"
+CirGateV
+CirMgr::foldAnd(const CirGateV& in0, const CirGateV& in1) const
+{
+   CirGate* const0 = _Gatelist[0];
+   if (in0.gate() == const0) return in0.isInv()? in1: CirGateV(const0);
+   if (in1.gate() == const0) return in1.isInv()? in0: CirGateV(const0);
+   if (in0 == in1) return in0;
+   if (in0.gate() == in1.gate()) return CirGateV(const0);
+   return CirGateV();
+}
+
+// Return the number of gates removed
+unsigned
+CirMgr::sweepUnreachable()
+{
+   DFS();
+   size_t n = 0;
+   for (size_t i = 0; i < _aig.size(); i++)
+      if (_aig[i]->_ref == _globalRef) _aig[n++] = _aig[i];
+   _aig.resize(n);
+   A = n;
+   unsigned nSwept = 0;
+   for (size_t id = 1; id < _Gatelist.size(); id++) {
+      CirGate* g = _Gatelist[id];
+      if (!g || g->_ref == _globalRef) continue;
+      if (g->_type != AIG_GATE && g->_type != UNDEF_GATE) continue;
+      _Gatelist[id] = 0;
+      _mem.free(g, sizeof(*g));
+      ++nSwept;
+   }
+   buildFanout();
+   return nSwept;
+}
@@ -0,0 +1,73 @@
+/****************************************************************************
+  FileName     [ cirOut.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the buffered text writer for netlist output ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_OUT_H
+#define CIR_OUT_H
+
+#include <cstring>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+// Bytes formatted before they are handed to the stream
+#define CIR_OUT_BUF_SIZE   (1 << 20)
+
+// Formats text into one static buffer and writes it to the stream a whole
+// buffer at a time, so a netlist costs one write per CIR_OUT_BUF_SIZE bytes
+// instead of a flush per line. Numbers are converted by hand. Only one
+// CirOutBuf may be alive at a time; the destructor writes what is left and
+// flushes the stream.
+class CirOutBuf
+{
+public:
+   CirOutBuf(ostream& os): _os(os), _ptr(_buf) {}
+   ~CirOutBuf() { flush(); _os.flush(); }
+
+   CirOutBuf& operator << (char c) {
+      if (_ptr == _buf + CIR_OUT_BUF_SIZE) flush();
+      *_ptr++ = c;
+      return *this;
+   }
+   CirOutBuf& operator << (const char* s) { return write(s, strlen(s)); }
+   CirOutBuf& operator << (const string& s) {
+      return write(s.data(), s.size());
+   }
+   CirOutBuf& operator << (unsigned n) { return operator << (size_t(n)); }
+   CirOutBuf& operator << (size_t n) {
+      if (_buf + CIR_OUT_BUF_SIZE - _ptr < 20) flush();
+      char digits[20];
+      char* p = digits + sizeof(digits);
+      do { *--p = '0' + n % 10; n /= 10; } while (n);
+      size_t len = digits + sizeof(digits) - p;
+      memcpy(_ptr, p, len);
+      _ptr += len;
+      return *this;
+   }
+
+   CirOutBuf& write(const char* s, size_t n) {
+      if (size_t(_buf + CIR_OUT_BUF_SIZE - _ptr) < n) {
+         flush();
+         if (n >= CIR_OUT_BUF_SIZE) { _os.write(s, n); return *this; }
+      }
+      memcpy(_ptr, s, n);
+      _ptr += n;
+      return *this;
+   }
+   void flush() {
+      if (_ptr != _buf) _os.write(_buf, _ptr - _buf);
+      _ptr = _buf;
+   }
+
+private:
+   ostream&       _os;
+   char*          _ptr;
+   static char    _buf[CIR_OUT_BUF_SIZE];
+};
+
+#endif // CIR_OUT_H
@@ -0,0 +1,809 @@
+/****************************************************************************
+  FileName     [ cirRewrite.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir cut-based rewriting functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// Leaves per cut; the truth tables are 16 bits
+#define RW_LEAF_MAX    4
+// Non-trivial cuts kept per gate
+#define RW_CUT_MAX     8
+// NPN transform: bits 0-4 pick one of the 24 input permutations, bits
+// 5-8 negate inputs and bit 9 the output
+#define RW_TRANS(p, neg, out)  ((p) | (neg) << 5 | (out) << 9)
+// Subgraph literals: CONST0/CONST1, leaf slot s, node k; odd is inverted
+#define RW_CONST0      0u
+#define RW_LEAF(s)     (2u * ((s) + 1))
+#define RW_NODE(k)     (2u * ((k) + RW_LEAF_MAX + 1))
+#define RW_NO_SLOT     unsigned(-1)
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Truth table over the leaves of a cut: bit m is the value when leaf i
+// is bit i of m
+typedef unsigned short RwTruth;
+
+static const RwTruth rwVarTruth[RW_LEAF_MAX] = {
+   0xAAAA, 0xCCCC, 0xF0F0, 0xFF00
+};
+
+// Up to RW_LEAF_MAX gate IDs in ascending order, and the function of the
+// cut root over them
+struct CirRwCut
+{
+   unsigned    _leaf[RW_LEAF_MAX];
+   RwTruth     _truth;
+   unsigned    _nLeaves;
+};
+
+// AND gates (_node[2k], _node[2k+1] are the fanins of node k) computing
+// _truth at _root
+struct RwGraph
+{
+   RwTruth           _truth;
+   vector<unsigned>  _node;
+   unsigned          _root;
+};
+
+// One subgraph for each of the 222 NPN classes of 4-input functions. A
+// function f is stored as transform _trans[f] of the smallest function
+// in its class, and _graph[_class[f]] computes one (any) member of the
+// class. The subgraphs are found by a dynamic program over the classes:
+// a class costs one AND (or three for an XOR) more than its two cheapest
+// operand classes, and the first decomposition found is kept. Shared
+// parts are merged when a graph is built, so it can be smaller than its
+// cost. They are not proved minimum, but the known minimum is reached for
+// the small classes that most cuts fall into.
+class RwLibrary
+{
+public:
+   RwLibrary();
+
+   const RwGraph& graph(RwTruth f) const { return _graph[_class[f]]; }
+   unsigned numClasses() const { return _graph.size(); }
+   // Graph(f) computes f when its leaf slot s is driven by leaf map[s]/2,
+   // inverted if map[s] is odd, and its root is inverted if true is
+   // returned
+   bool leafMap(RwTruth f, unsigned map[RW_LEAF_MAX]) const {
+      unsigned tf = _trans[f], tg = _trans[graph(f)._truth];
+      for (unsigned i = 0; i < RW_LEAF_MAX; i++)
+         map[_perm[tg & 31][i]] = 2 * _perm[tf & 31][i] +
+                                  (((tf ^ tg) >> (5 + i)) & 1);
+      return ((tf ^ tg) >> 9) & 1;
+   }
+
+private:
+   vector<unsigned short>  _class;   // by truth table
+   vector<unsigned short>  _trans;   // by truth table
+   vector<RwGraph>         _graph;   // by class
+   unsigned char           _perm[24][RW_LEAF_MAX];
+
+   // g(x) = o ^ f(y) with y_i = x_perm[i] ^ neg_i
+   RwTruth transform(RwTruth f, unsigned t) const {
+      const unsigned char* p = _perm[t & 31];
+      RwTruth g = 0;
+      for (unsigned x = 0; x < 16; x++) {
+         unsigned y = ((t >> 5) & 15);
+         for (unsigned i = 0; i < RW_LEAF_MAX; i++) y ^= ((x >> p[i]) & 1) << i;
+         if (((f >> y) ^ (t >> 9)) & 1) g |= 1 << x;
+      }
+      return g;
+   }
+   unsigned addNode(RwGraph& gr, unsigned a, unsigned b) const;
+   unsigned embed(RwGraph& gr, RwTruth f) const;
+   RwTruth simulate(const RwGraph& gr) const;
+};
+
+RwLibrary::RwLibrary(): _class(1 << 16), _trans(1 << 16)
+{
+   unsigned char perm[RW_LEAF_MAX] = { 0, 1, 2, 3 };
+   for (unsigned p = 0; p < 24; p++) {
+      copy(perm, perm + RW_LEAF_MAX, _perm[p]);
+      next_permutation(perm, perm + RW_LEAF_MAX);
+   }
+   // the smallest member of a class is met first and is its representative
+   vector<bool> done(1 << 16, false);
+   vector<RwTruth> rep;
+   vector<vector<RwTruth> > members;
+   for (unsigned f = 0; f < (1 << 16); f++) {
+      if (done[f]) continue;
+      members.push_back(vector<RwTruth>());
+      for (unsigned out = 0; out < 2; out++)
+         for (unsigned neg = 0; neg < 16; neg++)
+            for (unsigned p = 0; p < 24; p++) {
+               unsigned t = RW_TRANS(p, neg, out);
+               RwTruth g = transform(f, t);
+               if (done[g]) continue;
+               done[g] = true;
+               _class[g] = rep.size();
+               _trans[g] = t;
+               members.back().push_back(g);
+            }
+      rep.push_back(f);
+   }
+
+   // classes by cost; cost-0 classes are CONST0 and a single leaf
+   size_t nClasses = rep.size();
+   vector<unsigned> cost(nClasses, unsigned(-1));
+   vector<RwTruth> member(nClasses), in0(nClasses), in1(nClasses);
+   vector<bool> isXor(nClasses, false);
+   vector<vector<unsigned> > byCost(1);
+   RwTruth seeds[2] = { 0, rwVarTruth[0] };
+   for (unsigned s = 0; s < 2; s++) {
+      unsigned c = _class[seeds[s]];
+      cost[c] = 0;
+      member[c] = seeds[s];
+      byCost[0].push_back(c);
+   }
+   size_t nLeft = nClasses - 2;
+   for (unsigned k = 1; nLeft; k++) {
+      byCost.push_back(vector<unsigned>());
+      // f = rep(a) op h, with the cheaper operand transformed to its
+      // representative
+      for (unsigned i = 0; 2 * i + 1 <= k; i++)
+         for (unsigned j = i; i + j + 1 <= k; j++) {
+            bool xorOp = (i + j + 3 == k);
+            if (!xorOp && i + j + 1 != k) continue;
+            for (size_t a = 0; a < byCost[i].size(); a++) {
+               RwTruth r = rep[byCost[i][a]];
+               for (size_t b = 0; b < byCost[j].size(); b++) {
+                  const vector<RwTruth>& hs = members[byCost[j][b]];
+                  for (size_t q = 0; q < hs.size(); q++)
+                     for (unsigned ph = 0; ph < (xorOp? 1: 4); ph++) {
+                        RwTruth x = r ^ ((ph & 1)? 0xFFFF: 0);
+                        RwTruth y = hs[q] ^ ((ph & 2)? 0xFFFF: 0);
+                        RwTruth f = xorOp? (x ^ y): (x & y);
+                        unsigned c = _class[f];
+                        if (cost[c] != unsigned(-1)) continue;
+                        cost[c] = k;
+                        member[c] = f;
+                        in0[c] = x;
+                        in1[c] = y;
+                        isXor[c] = xorOp;
+                        byCost[k].push_back(c);
+                        --nLeft;
+                     }
+               }
+            }
+         }
+   }
+
+   // build the graphs cheapest first, so the operands are there
+   _graph.resize(nClasses);
+   for (size_t k = 0; k < byCost.size(); k++)
+      for (size_t n = 0; n < byCost[k].size(); n++) {
+         unsigned c = byCost[k][n];
+         RwGraph& gr = _graph[c];
+         gr._truth = member[c];
+         if (k == 0)
+            gr._root = member[c]? RW_LEAF(0): RW_CONST0;
+         else {
+            unsigned a = embed(gr, in0[c]), b = embed(gr, in1[c]);
+            if (isXor[c])
+               gr._root = addNode(gr, addNode(gr, a, b) ^ 1,
+                                  addNode(gr, a ^ 1, b ^ 1) ^ 1);
+            else gr._root = addNode(gr, a, b);
+         }
+         assert(simulate(gr) == gr._truth);
+      }
+}
+
+// Literal of AND(a, b) in "gr", folded or shared if possible
+unsigned
+RwLibrary::addNode(RwGraph& gr, unsigned a, unsigned b) const
+{
+   if (a > b) swap(a, b);
+   if (a == RW_CONST0 || a == (b ^ 1)) return RW_CONST0;
+   if (a == (RW_CONST0 ^ 1) || a == b) return b;
+   for (size_t k = 0; 2 * k < gr._node.size(); k++)
+      if (gr._node[2 * k] == a && gr._node[2 * k + 1] == b) return RW_NODE(k);
+   gr._node.push_back(a);
+   gr._node.push_back(b);
+   return RW_NODE(gr._node.size() / 2 - 1);
+}
+
+// Copy the graph of "f" into "gr" over the same leaves; return its root
+unsigned
+RwLibrary::embed(RwGraph& gr, RwTruth f) const
+{
+   const RwGraph& sub = graph(f);
+   unsigned map[RW_LEAF_MAX];
+   bool inv = leafMap(f, map);
+   vector<unsigned> lit(sub._node.size() / 2 + RW_LEAF_MAX + 1);
+   lit[0] = RW_CONST0;
+   for (unsigned s = 0; s < RW_LEAF_MAX; s++)
+      lit[s + 1] = RW_LEAF(map[s] / 2) ^ (map[s] & 1);
+   for (size_t k = 0; 2 * k < sub._node.size(); k++) {
+      unsigned a = sub._node[2 * k], b = sub._node[2 * k + 1];
+      lit[k + RW_LEAF_MAX + 1] = addNode(gr, lit[a / 2] ^ (a & 1),
+                                             lit[b / 2] ^ (b & 1));
+   }
+   return lit[sub._root / 2] ^ (sub._root & 1) ^ inv;
+}
+
+RwTruth
+RwLibrary::simulate(const RwGraph& gr) const
+{
+   vector<RwTruth> val(gr._node.size() / 2 + RW_LEAF_MAX + 1);
+   val[0] = 0;
+   for (unsigned s = 0; s < RW_LEAF_MAX; s++) val[s + 1] = rwVarTruth[s];
+   for (size_t k = 0; 2 * k < gr._node.size(); k++) {
+      unsigned a = gr._node[2 * k], b = gr._node[2 * k + 1];
+      val[k + RW_LEAF_MAX + 1] = (val[a / 2] ^ ((a & 1)? 0xFFFF: 0)) &
+                                 (val[b / 2] ^ ((b & 1)? 0xFFFF: 0));
+   }
+   return val[gr._root / 2] ^ ((gr._root & 1)? 0xFFFF: 0);
+}
+
+// Built by the first CIRRewrite
+static const RwLibrary&
+rwLibrary()
+{
+   static RwLibrary lib;
+   return lib;
+}
+
+// Truth table of "from" over the leaves of "to", which include its leaves.
+// Leaf i moves to its position j >= i in "to", last leaf first, by swapping
+// variables i and j; variable j is not used by then.
+static RwTruth
+stretchTruth(const CirRwCut& from, const CirRwCut& to)
+{
+   unsigned pos[RW_LEAF_MAX];
+   for (unsigned i = 0, j = 0; i < from._nLeaves; i++) {
+      while (to._leaf[j] != from._leaf[i]) ++j;
+      pos[i] = j;
+   }
+   unsigned t = from._truth;
+   for (unsigned i = from._nLeaves; i-- > 0; ) {
+      unsigned j = pos[i];
+      if (j == i) continue;
+      unsigned shift = (1 << j) - (1 << i);
+      unsigned m = rwVarTruth[i] & ~rwVarTruth[j];
+      t = (t & ~(m | m << shift)) | ((t & m) << shift) | ((t >> shift) & m);
+   }
+   return t;
+}
+
+// Leaves of "a" and "b" in "c"; false if there are too many
+static bool
+mergeLeaves(const CirRwCut& a, const CirRwCut& b, CirRwCut& c)
+{
+   unsigned i = 0, j = 0, n = 0;
+   while (i < a._nLeaves || j < b._nLeaves) {
+      if (n == RW_LEAF_MAX) return false;
+      if (j == b._nLeaves || (i < a._nLeaves && a._leaf[i] < b._leaf[j]))
+         c._leaf[n++] = a._leaf[i++];
+      else if (i == a._nLeaves || b._leaf[j] < a._leaf[i])
+         c._leaf[n++] = b._leaf[j++];
+      else { c._leaf[n++] = a._leaf[i++]; ++j; }
+   }
+   c._nLeaves = n;
+   return true;
+}
+
+// Are the leaves of "a" a subset of those of "b"?
+static bool
+cutSubset(const CirRwCut& a, const CirRwCut& b)
+{
+   unsigned j = 0;
+   for (unsigned i = 0; i < a._nLeaves; i++) {
+      while (j < b._nLeaves && b._leaf[j] < a._leaf[i]) ++j;
+      if (j == b._nLeaves || b._leaf[j] != a._leaf[i]) return false;
+   }
+   return true;
+}
+
+// AIG gates keyed by the fanin literals (2 * ID + inverted) they had when
+// inserted. A gate may be inserted again under new fanins, and removed
+// gates stay in the table; find() only returns gates still in _Gatelist.
+class RwHashTable
+{
+public:
+   RwHashTable(): _mask(0), _size(0) {}
+
+   void init(size_t nGates) {
+      size_t size = 16;
+      while (size < 2 * nGates) size <<= 1;
+      _table.assign(size, Entry());
+      _mask = size - 1;
+      _size = 0;
+   }
+   CirGate* find(unsigned k0, unsigned k1, const GateList& gates) const {
+      if (k0 > k1) swap(k0, k1);
+      for (size_t i = hash(k0, k1) & _mask; _table[i]._gate;
+           i = (i + 1) & _mask) {
+         const Entry& e = _table[i];
+         if (e._k0 == k0 && e._k1 == k1 && e._gate->getId() < gates.size() &&
+             gates[e._gate->getId()] == e._gate)
+            return e._gate;
+      }
+      return 0;
+   }
+   void insert(unsigned k0, unsigned k1, CirGate* g) {
+      if (2 * (_size + 1) > _table.size()) grow();
+      if (k0 > k1) swap(k0, k1);
+      size_t i = hash(k0, k1) & _mask;
+      while (_table[i]._gate) i = (i + 1) & _mask;
+      _table[i]._k0 = k0;
+      _table[i]._k1 = k1;
+      _table[i]._gate = g;
+      ++_size;
+   }
+
+private:
+   struct Entry {
+      Entry(): _k0(0), _k1(0), _gate(0) {}
+      unsigned _k0, _k1;
+      CirGate* _gate;
+   };
+   vector<Entry>  _table;
+   size_t         _mask;
+   size_t         _size;
+
+   static size_t hash(size_t k0, size_t k1) {
+      size_t h = k0 * 0x9e3779b97f4a7c15ULL ^ (k1 + 0x632be59bd9b4e019ULL);
+      return h ^ (h >> 29);
+   }
+   void grow() {
+      vector<Entry> old;
+      old.swap(_table);
+      _table.assign(2 * old.size(), Entry());
+      _mask = _table.size() - 1;
+      _size = 0;
+      for (size_t i = 0; i < old.size(); i++)
+         if (old[i]._gate) insert(old[i]._k0, old[i]._k1, old[i]._gate);
+   }
+};
+
+static inline unsigned
+litOf(const CirGateV& v)
+{
+   return 2 * v->getId() + v.isInv();
+}
+
+// State of one CIRRewrite pass; the vectors by gate ID grow with the
+// gates it creates. Cuts live in slots of RW_CUT_MAX; a slot is given back
+// once every fanout of its gate has computed its own cuts.
+struct CirRwData
+{
+   CirRwData(): _stamp0(0), _mffcSize(0), _nCutsTried(0), _nRewritten(0),
+                _nMerged(0) {}
+
+   IdList            _ref;        // live fanouts (reachable or not)
+   IdList            _pending;    // AIG fanouts whose cuts are not computed
+   vector<CirGateV>  _repl;       // replacement of a removed gate
+   IdList            _slot;       // cut slot or RW_NO_SLOT
+   IdList            _stamp;      // _stamp0: in the MFFC; +1: revived
+   unsigned          _stamp0;
+   unsigned          _mffcSize;   // of the cut being evaluated
+   vector<CirRwCut>  _cuts;       // RW_CUT_MAX per slot
+   IdList            _nCuts;      // per slot
+   IdList            _freeSlots;
+   RwHashTable       _table;
+   GateList          _removed;    // freed when the pass is over
+   GateList          _added;
+   GateList          _stack;
+   vector<CirGateV>  _sig;        // by subgraph node
+
+   size_t            _nCutsTried;
+   unsigned          _nRewritten, _nMerged;
+};
+
+/*********************************************/
+/*   Public member functions about rewrite   */
+/*********************************************/
+// Cut-based rewriting in one pass over _dfsList:
+// 1. A gate whose resolved fanins fold or match an existing gate is
+//    replaced right away.
+// 2. Otherwise its 4-feasible cuts are merged from those of its fanins.
+//    For each cut the library subgraph of the cut function is matched
+//    against the circuit: the gain is the size of the gate's MFFC (its
+//    maximum fanout-free cone, bounded by the cut leaves) minus the gates
+//    the subgraph has to add or keep alive.
+// 3. The subgraph of the best cut with a positive gain is built and the
+//    gate replaced by its root.
+// Replacements are applied lazily, as in strash(): a gate resolves its
+// fanins through _repl when it is visited, and the live fanout counts are
+// moved to the replacement at once, so MFFCs are always exact. New gates
+// take the IDs freed by removed ones at the end, so M does not grow.
+void
+CirMgr::rewrite()
+{
+   CirPhaseMark mark = phaseMark();
+   double start = getWallTime();
+   const RwLibrary& lib = rwLibrary();
+   double libTime = getWallTime() - start;
+   start += libTime;
+   size_t nBefore = _aig.size();
+
+   CirRwData d;
+   size_t nIds = _Gatelist.size();
+   d._ref.assign(nIds, 0);
+   d._pending.assign(nIds, 0);
+   d._repl.assign(nIds, CirGateV());
+   d._slot.assign(nIds, RW_NO_SLOT);
+   d._stamp.assign(nIds, 0);
+   d._table.init(_aig.size());
+   for (size_t i = 0; i < _aig.size(); i++) {
+      CirGate* g = _aig[i];
+      ++d._ref[g->_fanin[0]->_id];
+      ++d._ref[g->_fanin[1]->_id];
+      d._table.insert(litOf(g->_fanin[0]), litOf(g->_fanin[1]), g);
+   }
+   for (size_t i = 0; i < _out.size(); i++)
+      ++d._ref[_out[i]->_fanin[0]->_id];
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      CirGate* g = _dfsList[i];
+      if (g->_type != AIG_GATE) continue;
+      ++d._pending[g->_fanin[0]->_id];
+      ++d._pending[g->_fanin[1]->_id];
+   }
+
+   GateList order(_dfsList);
+   for (size_t i = 0; i < order.size(); i++) {
+      CirGate* g = order[i];
+      if (g->_type != AIG_GATE || _Gatelist[g->_id] != g) continue;
+      g->_fanin[0] = rwResolve(d, g->_fanin[0]);
+      g->_fanin[1] = rwResolve(d, g->_fanin[1]);
+      CirGateV r = foldGate(g);
+      if (!r.gate()) {
+         CirGate* h = d._table.find(litOf(g->_fanin[0]), litOf(g->_fanin[1]),
+                                    _Gatelist);
+         if (h && h != g) r = CirGateV(h);
+         else if (!h)
+            d._table.insert(litOf(g->_fanin[0]), litOf(g->_fanin[1]), g);
+      }
+      if (!r.gate()) rwComputeCuts(d, g);
+      rwDone(d, g->_fanin[0].gate());
+      rwDone(d, g->_fanin[1].gate());
+      if (r.gate()) {
+         rwReplace(d, g, r);
+         ++d._nMerged;
+         continue;
+      }
+
+      // the best cut, if any has a positive gain
+      const CirRwCut* cuts = &d._cuts[d._slot[g->_id] * RW_CUT_MAX];
+      int bestGain = 0;
+      unsigned best = 0;
+      for (unsigned c = 0; c < d._nCuts[d._slot[g->_id]]; c++) {
+         int gain = rwGain(d, g, cuts[c]);
+         ++d._nCutsTried;
+         if (gain > bestGain) { bestGain = gain; best = c; }
+      }
+      if (bestGain > 0) {
+         CirRwCut cut = cuts[best];
+         rwBuild(d, g, cut, 0, r);
+         rwReplace(d, g, r);
+         ++d._nRewritten;
+      }
+   }
+   rwFinish(d);
+
+   size_t nAfter = _aig.size();
+   cout << "Rewriting: " << nBefore - nAfter << " AIG gate(s) removed ("
+        << nBefore << " -> " << nAfter << ") in " << setprecision(4)
+        << getWallTime() - start << " seconds." << endl
+        << "  " << d._nCutsTried << " cut(s) evaluated, " << d._nRewritten
+        << " subgraph(s) replaced, " << d._nMerged << " gate(s) merged"
+        << endl;
+   if (libTime > 0.001)
+      cout << "  (subgraphs of the " << lib.numClasses()
+           << " NPN classes prepared in " << setprecision(4) << libTime
+           << " seconds)" << endl;
+   endPhase("rewrite", mark);
+}
+
+/**********************************************/
+/*   Private member functions about rewrite   */
+/**********************************************/
+// Follow the replacements of a removed gate to a live one
+CirGateV
+CirMgr::rwResolve(const CirRwData& d, CirGateV v) const
+{
+   while (d._repl[v->_id].gate()) {
+      const CirGateV& r = d._repl[v->_id];
+      v = CirGateV(r.gate(), r.isInv() ^ v.isInv());
+   }
+   return v;
+}
+
+// Cuts of "g" from those of its fanins; a fanin without cuts (not an
+// AIG, or its slot given back) contributes its trivial cut only
+void
+CirMgr::rwComputeCuts(CirRwData& d, CirGate* g)
+{
+   unsigned slot;
+   if (d._freeSlots.empty()) {
+      slot = d._nCuts.size();
+      d._nCuts.push_back(0);
+      d._cuts.resize(d._cuts.size() + RW_CUT_MAX);
+   }
+   else {
+      slot = d._freeSlots.back();
+      d._freeSlots.pop_back();
+   }
+   d._slot[g->_id] = slot;
+   CirRwCut* cuts = &d._cuts[slot * RW_CUT_MAX];
+   unsigned nCuts = 0;
+
+   const CirRwCut* in[2];
+   unsigned nIn[2];
+   CirRwCut trivial[2];
+   for (unsigned j = 0; j < 2; j++) {
+      const CirGate* f = g->_fanin[j].gate();
+      trivial[j]._leaf[0] = f->_id;
+      trivial[j]._nLeaves = 1;
+      trivial[j]._truth = rwVarTruth[0];
+      unsigned s = d._slot[f->_id];
+      in[j] = (s == RW_NO_SLOT)? 0: &d._cuts[s * RW_CUT_MAX];
+      nIn[j] = (s == RW_NO_SLOT)? 0: d._nCuts[s];
+   }
+   // the trivial cut of a fanin is tried first, so {fanin0, fanin1} is
+   // always kept
+   for (unsigned a = 0; a <= nIn[0]; a++)
+      for (unsigned b = 0; b <= nIn[1]; b++) {
+         const CirRwCut& ca = a? in[0][a - 1]: trivial[0];
+         const CirRwCut& cb = b? in[1][b - 1]: trivial[1];
+         CirRwCut c;
+         if (!mergeLeaves(ca, cb, c)) continue;
+         bool dominated = false;
+         unsigned n = 0;
+         for (unsigned k = 0; k < nCuts && !dominated; k++)
+            dominated = cutSubset(cuts[k], c);
+         if (dominated) continue;
+         // drop the kept cuts that "c" dominates
+         for (unsigned k = 0; k < nCuts; k++)
+            if (!cutSubset(c, cuts[k])) cuts[n++] = cuts[k];
+         nCuts = n;
+         if (nCuts == RW_CUT_MAX) continue;
+         c._truth = (stretchTruth(ca, c) ^ (g->_fanin[0].isInv()? 0xFFFF: 0)) &
+                    (stretchTruth(cb, c) ^ (g->_fanin[1].isInv()? 0xFFFF: 0));
+         cuts[nCuts++] = c;
+      }
+   d._nCuts[slot] = nCuts;
+}
+
+// "f" is done as a fanin of a gate whose cuts are computed
+void
+CirMgr::rwDone(CirRwData& d, CirGate* f)
+{
+   if (d._pending[f->_id] == 0 || --d._pending[f->_id]) return;
+   if (d._slot[f->_id] == RW_NO_SLOT) return;
+   d._freeSlots.push_back(d._slot[f->_id]);
+   d._slot[f->_id] = RW_NO_SLOT;
+}
+
+// Dereference the fanins of "g"; mark the AIGs whose last fanout goes
+// with d._stamp0 and return how many gates that is, "g" included
+unsigned
+CirMgr::rwDeref(CirRwData& d, CirGate* g)
+{
+   unsigned n = 1;
+   d._stamp[g->_id] = d._stamp0;
+   d._stack.assign(1, g);
+   while (!d._stack.empty()) {
+      CirGate* x = d._stack.back();
+      d._stack.pop_back();
+      for (unsigned j = 0; j < 2; j++) {
+         CirGate* f = rwResolve(d, x->_fanin[j]).gate();
+         if (--d._ref[f->_id] || f->_type != AIG_GATE) continue;
+         d._stamp[f->_id] = d._stamp0;
+         d._stack.push_back(f);
+         ++n;
+      }
+   }
+   return n;
+}
+
+// Undo rwDeref(d, g)
+void
+CirMgr::rwRef(CirRwData& d, CirGate* g)
+{
+   d._stack.assign(1, g);
+   while (!d._stack.empty()) {
+      CirGate* x = d._stack.back();
+      d._stack.pop_back();
+      for (unsigned j = 0; j < 2; j++) {
+         CirGate* f = rwResolve(d, x->_fanin[j]).gate();
+         if (d._ref[f->_id]++ == 0 && f->_type == AIG_GATE)
+            d._stack.push_back(f);
+      }
+   }
+}
+
+// Number of MFFC gates that stay if "g" is kept
+unsigned
+CirMgr::rwRevive(CirRwData& d, CirGate* g)
+{
+   if (d._stamp[g->_id] != d._stamp0) return 0;
+   unsigned n = 1;
+   d._stamp[g->_id] = d._stamp0 + 1;
+   d._stack.assign(1, g);
+   while (!d._stack.empty()) {
+      CirGate* x = d._stack.back();
+      d._stack.pop_back();
+      for (unsigned j = 0; j < 2; j++) {
+         CirGate* f = rwResolve(d, x->_fanin[j]).gate();
+         if (d._stamp[f->_id] != d._stamp0) continue;
+         d._stamp[f->_id] = d._stamp0 + 1;
+         d._stack.push_back(f);
+         ++n;
+      }
+   }
+   return n;
+}
+
+// Gates saved by replacing "g" with the subgraph of "cut"; 0 if none
+int
+CirMgr::rwGain(CirRwData& d, CirGate* g, const CirRwCut& cut)
+{
+   for (unsigned i = 0; i < cut._nLeaves; i++)
+      if (!_Gatelist[cut._leaf[i]]) return 0;
+   d._stamp0 += 2;
+   for (unsigned i = 0; i < cut._nLeaves; i++) ++d._ref[cut._leaf[i]];
+   d._mffcSize = rwDeref(d, g);
+   unsigned cost = 0;
+   CirGateV r;
+   int gain = rwBuild(d, g, cut, &cost, r)? d._mffcSize - cost: 0;
+   rwRef(d, g);
+   for (unsigned i = 0; i < cut._nLeaves; i++) --d._ref[cut._leaf[i]];
+   return gain;
+}
+
+// Implement the function of "cut" at "out" with its library subgraph,
+// sharing the gates that exist already. If "cost" is given nothing is
+// changed: the gates that would be added, and the gates of the MFFC
+// (marked d._stamp0) that would be kept, are counted instead, and "out"
+// is null if the root would be added. Return false if the subgraph would
+// use "root" itself, or when counting, once it costs the whole MFFC.
+bool
+CirMgr::rwBuild(CirRwData& d, CirGate* root, const CirRwCut& cut,
+                unsigned* cost, CirGateV& out)
+{
+   const RwLibrary& lib = rwLibrary();
+   const RwGraph& gr = lib.graph(cut._truth);
+   unsigned map[RW_LEAF_MAX];
+   bool inv = lib.leafMap(cut._truth, map);
+   CirGate* const0 = _Gatelist[0];
+   unsigned nNodes = gr._node.size() / 2;
+   d._sig.resize(nNodes + RW_LEAF_MAX + 1);
+   d._sig[0] = CirGateV(const0);
+   for (unsigned s = 0; s < RW_LEAF_MAX; s++) {
+      unsigned leaf = map[s] / 2;
+      CirGate* f = leaf < cut._nLeaves? _Gatelist[cut._leaf[leaf]]: const0;
+      d._sig[s + 1] = CirGateV(f, map[s] & 1);
+   }
+   for (unsigned k = 0; k < nNodes; k++) {
+      unsigned la = gr._node[2 * k], lb = gr._node[2 * k + 1];
+      CirGateV a = d._sig[la / 2], b = d._sig[lb / 2];
+      // a null literal is a gate that would be added
+      if (a.gate()) a = CirGateV(a.gate(), a.isInv() ^ (la & 1));
+      if (b.gate()) b = CirGateV(b.gate(), b.isInv() ^ (lb & 1));
+      CirGateV& v = d._sig[k + RW_LEAF_MAX + 1];
+      v = CirGateV();
+      if (a.gate() && b.gate()) {
+         v = foldAnd(a, b);
+         if (!v.gate()) {
+            CirGate* h = d._table.find(litOf(a), litOf(b), _Gatelist);
+            if (h == root) return false;
+            if (h) {
+               v = CirGateV(h);
+               if (cost) *cost += rwRevive(d, h);
+            }
+         }
+      }
+      if (!v.gate()) {
+         if (cost) ++*cost;
+         else v = CirGateV(rwNewGate(d, a, b));
+      }
+      if (cost && *cost >= d._mffcSize) return false;
+   }
+   out = d._sig[gr._root / 2];
+   if (out.gate())
+      out = CirGateV(out.gate(), out.isInv() ^ (gr._root & 1) ^ inv);
+   return true;
+}
+
+// A new AIG gate with an ID past the current ones
+CirGate*
+CirMgr::rwNewGate(CirRwData& d, const CirGateV& a, const CirGateV& b)
+{
+   unsigned id = _Gatelist.size();
+   CirGate* g = new (_mem) CirAigGate(id, 0);
+   g->_fanin[0] = a;
+   g->_fanin[1] = b;
+   _Gatelist.push_back(g);
+   d._ref.push_back(0);
+   d._pending.push_back(0);
+   d._repl.push_back(CirGateV());
+   d._slot.push_back(RW_NO_SLOT);
+   d._stamp.push_back(0);
+   ++d._ref[a->_id];
+   ++d._ref[b->_id];
+   d._table.insert(litOf(a), litOf(b), g);
+   rwComputeCuts(d, g);
+   d._added.push_back(g);
+   return g;
+}
+
+// Remove "g" and whatever only it uses; its fanouts move to "r"
+void
+CirMgr::rwReplace(CirRwData& d, CirGate* g, const CirGateV& r)
+{
+   d._ref[r->_id] += d._ref[g->_id];
+   d._pending[r->_id] += d._pending[g->_id];
+   d._ref[g->_id] = d._pending[g->_id] = 0;
+   d._repl[g->_id] = r;
+   d._stack.assign(1, g);
+   while (!d._stack.empty()) {
+      CirGate* x = d._stack.back();
+      d._stack.pop_back();
+      _Gatelist[x->_id] = 0;
+      d._removed.push_back(x);
+      if (d._slot[x->_id] != RW_NO_SLOT) {
+         d._freeSlots.push_back(d._slot[x->_id]);
+         d._slot[x->_id] = RW_NO_SLOT;
+      }
+      for (unsigned j = 0; j < 2; j++) {
+         CirGate* f = rwResolve(d, x->_fanin[j]).gate();
+         if (--d._ref[f->_id] == 0 && f->_type == AIG_GATE)
+            d._stack.push_back(f);
+      }
+   }
+}
+
+// Resolve all fanins, free the removed gates and give the new ones the
+// IDs left free
+void
+CirMgr::rwFinish(CirRwData& d)
+{
+   for (size_t i = 0; i < _out.size(); i++)
+      _out[i]->_fanin[0] = rwResolve(d, _out[i]->_fanin[0]);
+   size_t n = 0;
+   for (size_t i = 0; i < _aig.size(); i++)
+      if (_Gatelist[_aig[i]->_id] == _aig[i]) _aig[n++] = _aig[i];
+   _aig.resize(n);
+   for (size_t i = 0; i < d._added.size(); i++)
+      if (_Gatelist[d._added[i]->_id] == d._added[i])
+         _aig.push_back(d._added[i]);
+   for (size_t i = 0; i < _aig.size(); i++)
+      for (unsigned j = 0; j < 2; j++)
+         _aig[i]->_fanin[j] = rwResolve(d, _aig[i]->_fanin[j]);
+   for (size_t i = 0; i < d._removed.size(); i++)
+      _mem.free(d._removed[i], sizeof(*d._removed[i]));
+
+   size_t hole = 1;
+   for (size_t i = 0; i < d._added.size(); i++) {
+      CirGate* g = d._added[i];
+      if (_Gatelist[g->_id] != g) continue;
+      while (_Gatelist[hole]) ++hole;
+      assert(hole <= M);
+      _Gatelist[g->_id] = 0;
+      g->_id = hole;
+      _Gatelist[hole] = g;
+   }
+   _Gatelist.resize(M + O + 1);
+   A = _aig.size();
+   buildFanout();
+   DFS();
+   clearFecGrps();
+}
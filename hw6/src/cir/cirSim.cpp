@@ -0,0 +1,553 @@
+/****************************************************************************
+  FileName     [ cirSim.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir simulation functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIM_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// Number of 64-bit words per gate simulated by "CIRSIMulate -Random"
+#define SIM_RANDOM_WORDS 64
+// Word x gate evaluations per measurement in "CIRSIMulate -Bench"
+#define SIM_BENCH_EVALS  (1 << 26)
+// Circuits with fewer AIGs + POs are always simulated on one thread
+#define SIM_MT_MIN_GATES 20000
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static size_t
+randomWord()
+{
+   size_t word = 0;
+   for (int i = 0; i < 4; i++)
+      word = (word << 16) | (size_t)rnGen(1 << 16);
+   return word;
+}
+
+// Strict weak ordering of gate IDs by their simulation values, with each
+// value complemented if its first bit is 1 so that a gate and its inverse
+// compare equal
+struct FecSigLess
+{
+   FecSigLess(const size_t* value, size_t nWords):
+      _value(value), _nWords(nWords) {}
+   bool operator() (unsigned a, unsigned b) const {
+      const size_t* va = _value + a * _nWords;
+      const size_t* vb = _value + b * _nWords;
+      size_t ia = (va[0] & 1)? ~size_t(0): 0, ib = (vb[0] & 1)? ~size_t(0): 0;
+      for (size_t w = 0; w < _nWords; w++)
+         if ((va[w] ^ ia) != (vb[w] ^ ib)) return (va[w] ^ ia) < (vb[w] ^ ib);
+      return false;
+   }
+   const size_t* _value;
+   size_t        _nWords;
+};
+
+// A member of a candidate class during refinement
+struct FecEntry
+{
+   FecEntry(size_t hash, unsigned id, unsigned pos):
+      _hash(hash), _id(id), _pos(pos) {}
+   size_t   _hash;
+   unsigned _id;
+   unsigned _pos;   // position in the class before refinement
+};
+
+struct FecEntryLess
+{
+   FecEntryLess(const FecSigLess& sigLess): _sigLess(sigLess) {}
+   bool operator() (const FecEntry& a, const FecEntry& b) const {
+      if (a._hash != b._hash) return a._hash < b._hash;
+      if (_sigLess(a._id, b._id)) return true;
+      if (_sigLess(b._id, a._id)) return false;
+      return a._pos < b._pos;
+   }
+   const FecSigLess& _sigLess;
+};
+
+static bool
+checkPattern(const string& pattern, unsigned nPI)
+{
+   if (pattern.size() != nPI) {
+      cerr << "Error: Pattern(" << pattern << ") length(" << pattern.size()
+           << ") does not match the number of inputs(" << nPI
+           << ") in a circuit!!" << endl;
+      return false;
+   }
+   for (unsigned i = 0; i < nPI; i++) {
+      if (pattern[i] != '0' && pattern[i] != '1') {
+         cerr << "Error: Pattern(" << pattern << ") contains a non-0/1 "
+              << "character('" << pattern[i] << "')." << endl;
+         return false;
+      }
+   }
+   return true;
+}
+
+// Simulation kernels; "value" holds "nWords" words per gate and the
+// SimNode offsets are already scaled by nWords
+typedef void (*SimKernel)(const CirMgr::SimNode*, size_t, size_t*);
+
+static void
+simKernel64(const CirMgr::SimNode* node, size_t n, size_t* value)
+{
+   for (size_t i = 0; i < n; i++, node++)
+      value[node->_out] = (value[node->_in0] ^ node->_inv0) &
+                          (value[node->_in1] ^ node->_inv1);
+}
+
+#ifdef SIM_X86_SIMD
+__attribute__((target("avx2"))) static void
+simKernel256(const CirMgr::SimNode* node, size_t n, size_t* value)
+{
+   for (size_t i = 0; i < n; i++, node++) {
+      __m256i in0 = _mm256_loadu_si256((const __m256i*)(value + node->_in0));
+      __m256i in1 = _mm256_loadu_si256((const __m256i*)(value + node->_in1));
+      __m256i inv0 = _mm256_set1_epi64x(node->_inv0);
+      __m256i inv1 = _mm256_set1_epi64x(node->_inv1);
+      _mm256_storeu_si256((__m256i*)(value + node->_out),
+         _mm256_and_si256(_mm256_xor_si256(in0, inv0),
+                          _mm256_xor_si256(in1, inv1)));
+   }
+}
+
+__attribute__((target("avx512f"))) static void
+simKernel512(const CirMgr::SimNode* node, size_t n, size_t* value)
+{
+   for (size_t i = 0; i < n; i++, node++) {
+      __m512i in0 = _mm512_loadu_si512((const void*)(value + node->_in0));
+      __m512i in1 = _mm512_loadu_si512((const void*)(value + node->_in1));
+      __m512i inv0 = _mm512_set1_epi64(node->_inv0);
+      __m512i inv1 = _mm512_set1_epi64(node->_inv1);
+      _mm512_storeu_si512((void*)(value + node->_out),
+         _mm512_and_si512(_mm512_xor_si512(in0, inv0),
+                          _mm512_xor_si512(in1, inv1)));
+   }
+}
+#endif
+
+// Available kernels, widest first
+struct SimKernelInfo {
+   const char* _name;
+   unsigned    _nWords;
+   SimKernel   _kernel;
+};
+
+static const SimKernelInfo simKernels[] = {
+#ifdef SIM_X86_SIMD
+   { "AVX-512", 8, simKernel512 },
+   { "AVX2",    4, simKernel256 },
+#endif
+   { "scalar",  1, simKernel64 }
+};
+
+static bool
+kernelSupported(const SimKernelInfo& k)
+{
+#ifdef SIM_X86_SIMD
+   if (k._nWords == 8) return __builtin_cpu_supports("avx512f");
+   if (k._nWords == 4) return __builtin_cpu_supports("avx2");
+#endif
+   return true;
+}
+
+// Level-parallel evaluation: the calling thread and (nThreads - 1) workers
+// split every level of the simulation list evenly and meet at a barrier
+// before starting the next level.
+class CirSimPool
+{
+public:
+   CirSimPool(unsigned nThreads): _nThreads(nThreads), _runId(0),
+      _exit(false), _kernel(0), _list(0), _levelStart(0), _nBounds(0),
+      _value(0), _arrived(0), _phase(0) {
+      for (unsigned t = 1; t < _nThreads; t++)
+         _workers.push_back(thread(&CirSimPool::work, this, t));
+   }
+   ~CirSimPool() {
+      {
+         lock_guard<mutex> lock(_mutex);
+         _exit = true;
+      }
+      _start.notify_all();
+      for (size_t t = 0; t < _workers.size(); t++) _workers[t].join();
+   }
+
+   void run(SimKernel kernel, const CirMgr::SimNode* list,
+            const IdList& levelStart, size_t* value) {
+      {
+         lock_guard<mutex> lock(_mutex);
+         _kernel = kernel; _list = list;
+         _levelStart = &levelStart; _nBounds = levelStart.size();
+         _value = value;
+         ++_runId;
+      }
+      _start.notify_all();
+      evalLevels(0, levelStart.size());
+   }
+
+private:
+   unsigned                   _nThreads;
+   vector<thread>             _workers;
+   mutex                      _mutex;
+   condition_variable         _start;
+   unsigned                   _runId;
+   bool                       _exit;
+
+   // the current job; written under _mutex by run()
+   SimKernel                  _kernel;
+   const CirMgr::SimNode*     _list;
+   const IdList*              _levelStart;
+   size_t                     _nBounds;     // _levelStart->size()
+   size_t*                    _value;
+
+   // barrier
+   atomic<unsigned>           _arrived;
+   atomic<unsigned>           _phase;
+
+   void work(unsigned tid) {
+      unsigned seen = 0;
+      while (true) {
+         size_t nBounds;
+         {
+            unique_lock<mutex> lock(_mutex);
+            while (!_exit && _runId == seen) _start.wait(lock);
+            if (_exit) return;
+            seen = _runId;
+            nBounds = _nBounds;
+         }
+         evalLevels(tid, nBounds);
+      }
+   }
+   // The level list is only read before the barrier of each level: once
+   // the last one is passed, run() may return and the caller resize it.
+   // So the loop is bounded by "nBounds", taken when the job was posted.
+   void evalLevels(unsigned tid, size_t nBounds) {
+      const IdList& levelStart = *_levelStart;
+      for (size_t l = 0; l + 1 < nBounds; l++) {
+         size_t b = levelStart[l], n = levelStart[l+1] - b;
+         size_t from = b + n * tid / _nThreads;
+         size_t to = b + n * (tid + 1) / _nThreads;
+         if (to > from) _kernel(_list + from, to - from, _value);
+         barrier();
+      }
+   }
+   void barrier() {
+      unsigned phase = _phase.load();
+      if (_arrived.fetch_add(1) + 1 == _nThreads) {
+         _arrived.store(0);
+         _phase.fetch_add(1);
+      }
+      else while (_phase.load() == phase) this_thread::yield();
+   }
+};
+
+/************************************************/
+/*   Public member functions about Simulation   */
+/************************************************/
+// Every pass also refines the FEC groups, which are formed on the first
+// simulation of a circuit
+void
+CirMgr::randomSim()
+{
+   CirPhaseMark mark = phaseMark();
+   buildSimList();
+   if (_fecGrpBegin.empty()) initFecGrps();
+   unsigned passBits = _simWords * SIM_WORD_BITS;
+   vector<size_t> piWords(I * _simWords);
+   size_t nPatterns = 0;
+   for (unsigned w = 0; w < SIM_RANDOM_WORDS; w += _simWords) {
+      randomPatterns(piWords);
+      simulate(piWords);
+      refineFecGrps();
+      writeSimLog(passBits);
+      nPatterns += passBits;
+   }
+   cout << nPatterns << " patterns simulated." << endl;
+   endPhase("sim", mark);
+}
+
+// A pattern is a string of I '0'/'1' characters; patterns are separated by
+// white spaces. They are packed _simWords * SIM_WORD_BITS at a time into
+// piWords.
+void
+CirMgr::fileSim(ifstream& patternFile)
+{
+   CirPhaseMark mark = phaseMark();
+   buildSimList();
+   if (_fecGrpBegin.empty()) initFecGrps();
+   unsigned passBits = _simWords * SIM_WORD_BITS;
+   vector<size_t> piWords(I * _simWords, 0);
+   size_t nPatterns = 0;
+   unsigned nBits = 0;
+   string pattern;
+   while (patternFile >> pattern) {
+      if (!checkPattern(pattern, I)) { nBits = 0; break; }
+      size_t bit = size_t(1) << (nBits % SIM_WORD_BITS);
+      unsigned word = nBits / SIM_WORD_BITS;
+      for (unsigned i = 0; i < I; i++)
+         if (pattern[i] == '1') piWords[i * _simWords + word] |= bit;
+      if (++nBits == passBits) {
+         simulate(piWords);
+         refineFecGrps();
+         writeSimLog(nBits);
+         nPatterns += nBits;
+         nBits = 0;
+         fill(piWords.begin(), piWords.end(), 0);
+      }
+   }
+   if (nBits) {
+      simulate(piWords);
+      refineFecGrps();
+      writeSimLog(nBits);
+      nPatterns += nBits;
+   }
+   cout << nPatterns << " patterns simulated." << endl;
+   endPhase("sim", mark);
+}
+
+// Run every kernel supported by this CPU on the same random patterns and
+// report the throughput in (pattern x gate) evaluations per second
+void
+CirMgr::benchSim()
+{
+   unsigned nKernels = sizeof(simKernels) / sizeof(simKernels[0]);
+   buildSimList();
+   // words per gate, a multiple of the widest kernel
+   size_t nWords = SIM_BENCH_EVALS / max(_simList.size(), size_t(1));
+   nWords = max(nWords - nWords % 8, size_t(8));
+   cout << "Kernel     Patterns/pass   Time(s)   Patterns x gates/s" << endl;
+   for (unsigned k = 0; k < nKernels; k++) {
+      if (!kernelSupported(simKernels[k])) {
+         cout << setw(11) << left << simKernels[k]._name
+              << "not supported by this CPU" << endl;
+         continue;
+      }
+      _simKernel = k;
+      buildSimList();
+      vector<size_t> piWords(I * _simWords);
+      randomPatterns(piWords);
+      double start = getWallTime();
+      for (size_t w = 0; w < nWords; w += _simWords)
+         simulate(piWords);
+      double t = getWallTime() - start;
+      double evals = double(nWords) * SIM_WORD_BITS * _simList.size();
+      cout << setw(11) << left << simKernels[k]._name
+           << setw(16) << left << _simWords * SIM_WORD_BITS
+           << setw(10) << left << setprecision(4) << t
+           << setprecision(4) << (t > 0? evals / t: 0) << endl;
+   }
+   _simKernel = -1;
+
+   // Thread scaling of the level-parallel mode with the default kernel;
+   // the small-circuit fallback is bypassed so that the crossover shows
+   unsigned maxThreads = _simThreads;
+   if (maxThreads <= 1) maxThreads = thread::hardware_concurrency();
+   if (maxThreads == 0) maxThreads = 1;
+   unsigned saveThreads = _simThreads;
+   double base = 0;
+   cout << endl << "Threads    Levels   Time(s)   Patterns x gates/s   Speedup"
+        << endl;
+   for (unsigned nThreads = 1; ; nThreads *= 2) {
+      if (nThreads > maxThreads) nThreads = maxThreads;
+      _simThreads = nThreads;
+      buildSimList(true);
+      vector<size_t> piWords(I * _simWords);
+      randomPatterns(piWords);
+      double start = getWallTime();
+      for (size_t w = 0; w < nWords; w += _simWords)
+         simulate(piWords);
+      double t = getWallTime() - start;
+      if (nThreads == 1) base = t;
+      double evals = double(nWords) * SIM_WORD_BITS * _simList.size();
+      cout << setw(11) << left << nThreads
+           << setw(9) << left << _simLevelStart.size() - 1
+           << setw(10) << left << setprecision(4) << t
+           << setw(21) << left << setprecision(4) << (t > 0? evals / t: 0)
+           << setprecision(3) << (t > 0? base / t: 0) << endl;
+      if (nThreads == maxThreads) break;
+   }
+   _simThreads = saveThreads;
+   buildSimList();
+}
+
+/*************************************************/
+/*   Private member functions about Simulation   */
+/*************************************************/
+// Flatten the AIGs and POs of _dfsList into _simList so that one pass is
+// a tight loop: each entry reads two fanin words, XORs the inversion masks
+// and ANDs them. A PO uses CONST0's all-ones complement as its second fanin.
+// The widest kernel this CPU supports is picked unless _simKernel is set.
+// The list is in the order of _levelList (_simLevelStart[l] is the first
+// node of level l + 1) so that a level can be split among threads.
+void
+CirMgr::buildSimList(bool forceThreads)
+{
+   unsigned k = 0;
+   if (_simKernel >= 0) k = _simKernel;
+   else while (!kernelSupported(simKernels[k])) ++k;
+   _simWords = simKernels[k]._nWords;
+   _simValue.assign(_Gatelist.size() * _simWords, 0);
+
+   // _levelList past level 0 holds exactly the AIGs and POs
+   size_t first = _levelStart[1], nNodes = _levelList.size() - first;
+   _simLevelStart.resize(_levelStart.size() - 1);
+   for (size_t lv = 0; lv < _simLevelStart.size(); lv++)
+      _simLevelStart[lv] = _levelStart[lv+1] - first;
+
+   _simList.resize(nNodes);
+   for (size_t i = 0; i < nNodes; i++) {
+      const CirGate* g = _levelList[first + i];
+      SimNode& node = _simList[i];
+      node._out = g->_id * _simWords;
+      node._in0 = g->_fanin[0]->_id * _simWords;
+      node._inv0 = g->_fanin[0].isInv()? ~size_t(0): 0;
+      if (g->_type == AIG_GATE) {
+         node._in1 = g->_fanin[1]->_id * _simWords;
+         node._inv1 = g->_fanin[1].isInv()? ~size_t(0): 0;
+      }
+      else { node._in1 = 0; node._inv1 = ~size_t(0); }
+   }
+
+   deleteSimPool();
+   if (_simThreads > 1 && (forceThreads || nNodes >= SIM_MT_MIN_GATES))
+      _simPool = new CirSimPool(_simThreads);
+}
+
+void
+CirMgr::deleteSimPool()
+{
+   delete _simPool;
+   _simPool = 0;
+}
+
+void
+CirMgr::simulate(const vector<size_t>& piWords)
+{
+   assert(piWords.size() == I * _simWords);
+   size_t* value = &_simValue[0];
+   for (unsigned i = 0; i < I; i++)
+      for (unsigned w = 0; w < _simWords; w++)
+         value[_in[i]->_id * _simWords + w] = piWords[i * _simWords + w];
+   if (_simList.empty()) return;
+   unsigned k = 0;
+   while (simKernels[k]._nWords != _simWords) ++k;
+   if (_simPool)
+      _simPool->run(simKernels[k]._kernel, &_simList[0], _simLevelStart, value);
+   else
+      simKernels[k]._kernel(&_simList[0], _simList.size(), value);
+}
+
+void
+CirMgr::randomPatterns(vector<size_t>& piWords) const
+{
+   for (size_t i = 0; i < piWords.size(); i++) piWords[i] = randomWord();
+}
+
+// One line per pattern: "<PI values> <PO values>"
+void
+CirMgr::writeSimLog(unsigned nBits) const
+{
+   if (!_simLog) return;
+   string line(I + O + 1, ' ');
+   for (unsigned k = 0; k < nBits; k++) {
+      unsigned word = k / SIM_WORD_BITS, bit = k % SIM_WORD_BITS;
+      for (unsigned i = 0; i < I; i++)
+         line[i] = '0' + ((_simValue[_in[i]->_id * _simWords + word] >> bit) & 1);
+      for (unsigned i = 0; i < O; i++)
+         line[I + 1 + i] =
+            '0' + ((_simValue[_out[i]->_id * _simWords + word] >> bit) & 1);
+      *_simLog << line << '\n';
+   }
+}
+
+// Put CONST0 and every AIG in _dfsList into one candidate class
+void
+CirMgr::initFecGrps()
+{
+   _fecList.assign(1, 0);
+   for (size_t i = 0; i < _dfsList.size(); i++)
+      if (_dfsList[i]->_type == AIG_GATE)
+         _fecList.push_back(2 * _dfsList[i]->_id);
+   _fecGrpOf.assign(_Gatelist.size(), FEC_NONE);
+   _fecGrpBegin.assign(1, 0);
+   if (_fecList.size() < 2) { _fecList.clear(); return; }
+   _fecGrpBegin.push_back(_fecList.size());
+   for (size_t k = 0; k < _fecList.size(); k++) _fecGrpOf[_fecList[k] / 2] = 0;
+}
+
+void
+CirMgr::clearFecGrps()
+{
+   _fecList.clear();
+   _fecGrpBegin.clear();
+   _fecGrpOf.clear();
+}
+
+// Split every class by the values of the last simulation pass, in place:
+// the members of a class are hashed by their normalised signature, sorted
+// by (hash, signature, position) and cut into runs; runs of two or more
+// are written back at the front of _fecList. The position tie-break keeps
+// every class in DFS order, and nothing is allocated per class. Members
+// whose _fecGrpOf was reset to FEC_NONE are dropped.
+void
+CirMgr::refineFecGrps()
+{
+   if (_fecGrpBegin.empty()) return;
+   FecSigLess sigLess(&_simValue[0], _simWords);
+   vector<FecEntry> entries;
+   IdList begin(1, 0);
+   size_t out = 0;
+   for (size_t j = 0; j + 1 < _fecGrpBegin.size(); j++) {
+      entries.clear();
+      for (size_t k = _fecGrpBegin[j]; k < _fecGrpBegin[j+1]; k++) {
+         unsigned id = _fecList[k] / 2;
+         if (_fecGrpOf[id] == FEC_NONE) continue;
+         _fecGrpOf[id] = FEC_NONE;
+         const size_t* v = &_simValue[id * _simWords];
+         size_t inv = (v[0] & 1)? ~size_t(0): 0, h = 0;
+         for (size_t w = 0; w < _simWords; w++)
+            h = (h ^ (v[w] ^ inv)) * 0x9e3779b97f4a7c15ULL;
+         entries.push_back(FecEntry(h ^ (h >> 31), id, entries.size()));
+      }
+      sort(entries.begin(), entries.end(), FecEntryLess(sigLess));
+      for (size_t b = 0, e; b < entries.size(); b = e) {
+         for (e = b + 1; e < entries.size(); e++)
+            if (entries[e]._hash != entries[b]._hash ||
+                sigLess(entries[b]._id, entries[e]._id)) break;
+         if (e - b < 2) continue;
+         for (size_t k = b; k < e; k++) {
+            unsigned id = entries[k]._id;
+            _fecList[out++] = 2 * id + (_simValue[id * _simWords] & 1);
+            _fecGrpOf[id] = begin.size() - 1;
+         }
+         begin.push_back(out);
+      }
+   }
+   _fecList.resize(out);
+   _fecGrpBegin.swap(begin);
+}
@@ -0,0 +1,368 @@
+/****************************************************************************
+  FileName     [ cirSnap.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir snapshot writing and loading functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// Bumped whenever the layout below changes; older snapshots are refused
+#define SNAP_VERSION    1
+// Written as a number, read back to catch a snapshot of the other byte order
+#define SNAP_ORDER      0x01020304u
+// Type of an empty _Gatelist slot
+#define SNAP_NO_GATE    unsigned(TOT_GATE)
+// Fanin literal of an unused fanin
+#define SNAP_NO_LIT     unsigned(-1)
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// A snapshot is the header followed by unsigned arrays, in this order:
+//   slots    _nSlots CirSnapGate records, one per _Gatelist entry
+//   in/out   I + O gate IDs of _in and _out
+//   aig      A gate IDs of _aig
+//   fanout   _nEdges literals (2 * ID + inverted), the _foNum fanouts of
+//            each slot in turn
+//   dfs      _nDfs gate IDs of _dfsList
+//   names    _nameBytes of NUL-terminated PI/PO names
+// Gates refer to each other by ID only, so the file does not depend on
+// where it is mapped. All numbers are in the byte order of the writer.
+struct CirSnapHeader
+{
+   char     _magic[8];
+   unsigned _version;
+   unsigned _order;
+   unsigned _M, _I, _L, _O, _A;
+   unsigned _nSlots, _nEdges, _nDfs, _nameBytes;
+};
+
+struct CirSnapGate
+{
+   unsigned _type;       // GateType or SNAP_NO_GATE
+   unsigned _lineNo;
+   unsigned _fanin[2];   // literals; SNAP_NO_LIT if not used
+   unsigned _foNum;
+   unsigned _name;       // 1 + offset in the names; 0 if none
+};
+
+static const char snapMagic[8] = { 'C', 'I', 'R', 'S', 'N', 'A', 'P', '\n' };
+
+static inline unsigned
+snapLit(const CirGateV& v)
+{
+   return 2 * v->getId() + v.isInv();
+}
+
+static size_t
+snapSize(const CirSnapHeader& h)
+{
+   size_t words = size_t(h._nSlots) * (sizeof(CirSnapGate) / sizeof(unsigned))
+                + size_t(h._I) + h._O + h._A + h._nEdges + h._nDfs;
+   return sizeof(CirSnapHeader) + words * sizeof(unsigned) + h._nameBytes;
+}
+
+static bool
+snapError(const string& fileName, const string& msg)
+{
+   cerr << "Error: snapshot \"" << fileName << "\" " << msg << "!!" << endl;
+   return false;
+}
+
+/**********************************************/
+/*   Public member functions about snapshot   */
+/**********************************************/
+// CIRWrite -Snapshot: the connected gate table as it is in memory, with
+// its fanouts, names and DFS order, so that readSnapshot() can restore the
+// circuit without parsing or connecting anything
+void
+CirMgr::writeSnapshot(ostream& outfile) const
+{
+   CirSnapHeader h;
+   memset(&h, 0, sizeof(h));
+   memcpy(h._magic, snapMagic, sizeof(snapMagic));
+   h._version = SNAP_VERSION;
+   h._order = SNAP_ORDER;
+   h._M = M; h._I = _in.size(); h._L = L; h._O = _out.size();
+   h._A = _aig.size();
+   h._nSlots = _Gatelist.size();
+   h._nDfs = _dfsList.size();
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      const CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      h._nEdges += g->_foNum;
+      if (g->_name) h._nameBytes += strlen(g->_name) + 1;
+   }
+
+   CirOutBuf out(outfile);
+   out.write((const char*)&h, sizeof(h));
+   unsigned nameOff = 0;
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      const CirGate* g = _Gatelist[id];
+      CirSnapGate r;
+      memset(&r, 0, sizeof(r));
+      r._type = g? unsigned(g->_type): SNAP_NO_GATE;
+      r._fanin[0] = r._fanin[1] = SNAP_NO_LIT;
+      if (g) {
+         r._lineNo = g->_lineNo;
+         for (unsigned j = 0; j < g->getFaninNum(); j++)
+            r._fanin[j] = snapLit(g->_fanin[j]);
+         r._foNum = g->_foNum;
+         if (g->_name) {
+            r._name = nameOff + 1;
+            nameOff += strlen(g->_name) + 1;
+         }
+      }
+      out.write((const char*)&r, sizeof(r));
+   }
+   const GateList* lists[3] = { &_in, &_out, &_aig };
+   for (int l = 0; l < 3; l++)
+      for (size_t i = 0; i < lists[l]->size(); i++) {
+         unsigned id = (*lists[l])[i]->_id;
+         out.write((const char*)&id, sizeof(id));
+      }
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      const CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      for (unsigned k = 0; k < g->_foNum; k++) {
+         unsigned lit = snapLit(g->_fanout[k]);
+         out.write((const char*)&lit, sizeof(lit));
+      }
+   }
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      unsigned id = _dfsList[i]->_id;
+      out.write((const char*)&id, sizeof(id));
+   }
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      const CirGate* g = _Gatelist[id];
+      if (g && g->_name) out.write(g->_name, strlen(g->_name) + 1);
+   }
+}
+
+// CIRRead -Snapshot: map a file of writeSnapshot() and rebuild the gates,
+// fanout arrays and DFS list straight from its records. Every ID in the
+// file is checked before it is used, and the gate lists, fanouts and DFS
+// order are checked against the fanins, so a damaged snapshot is refused
+// rather than followed.
+bool
+CirMgr::readSnapshot(const string& fileName)
+{
+   CirPhaseMark mark = phaseMark();
+   int fd = open(fileName.c_str(), O_RDONLY);
+   if (fd < 0) {
+      cerr<<"Cannot open design \""<<fileName<<"\"!!"<<endl;
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CirSnapHeader)) {
+      close(fd);
+      return snapError(fileName, "is too short");
+   }
+   size_t fileSize = st.st_size;
+   void* mem = mmap(0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (mem == MAP_FAILED) {
+      cerr<<"Cannot open design \""<<fileName<<"\"!!"<<endl;
+      return false;
+   }
+   bool ok = loadSnapshot((const char*)mem, fileSize, fileName);
+   munmap(mem, fileSize);
+   if (ok) endPhase("snapshot", mark);
+   return ok;
+}
+
+/***********************************************/
+/*   Private member functions about snapshot   */
+/***********************************************/
+bool
+CirMgr::loadSnapshot(const char* base, size_t size, const string& fileName)
+{
+   const CirSnapHeader& h = *(const CirSnapHeader*)base;
+   if (memcmp(h._magic, snapMagic, sizeof(snapMagic)) != 0)
+      return snapError(fileName, "is not a circuit snapshot");
+   if (h._order != SNAP_ORDER)
+      return snapError(fileName, "was written with another byte order");
+   if (h._version != SNAP_VERSION) {
+      cerr << "Error: snapshot \"" << fileName << "\" has version "
+           << h._version << ", but version " << SNAP_VERSION
+           << " is expected!!" << endl;
+      return false;
+   }
+   if (h._nSlots != size_t(h._M) + h._O + 1 || snapSize(h) != size)
+      return snapError(fileName, "is truncated or corrupted");
+
+   const CirSnapGate* slot = (const CirSnapGate*)(base + sizeof(h));
+   const unsigned* inId = (const unsigned*)(slot + h._nSlots);
+   const unsigned* outId = inId + h._I;
+   const unsigned* aigId = outId + h._O;
+   const unsigned* foLit = aigId + h._A;
+   const unsigned* dfsId = foLit + h._nEdges;
+   const char* names = (const char*)(dfsId + h._nDfs);
+   if (h._nameBytes && names[h._nameBytes - 1] != '\0')
+      return snapError(fileName, "is truncated or corrupted");
+
+   M = h._M; I = h._I; L = h._L; O = h._O; A = h._A;
+   _Gatelist.assign(h._nSlots, 0);
+   size_t nEdges = 0;
+   unsigned nOfType[TOT_GATE] = { 0 };
+   for (unsigned id = 0; id < h._nSlots; id++) {
+      const CirSnapGate& r = slot[id];
+      CirGate* g = 0;
+      switch (r._type) {
+         case SNAP_NO_GATE: continue;
+         case CONST_GATE:
+            if (id == 0) g = new (_mem) CirConstGate();
+            break;
+         case PI_GATE:  g = new (_mem) CirPiGate(id, r._lineNo);  break;
+         case PO_GATE:  g = new (_mem) CirPoGate(id, r._lineNo);  break;
+         case AIG_GATE: g = new (_mem) CirAigGate(id, r._lineNo); break;
+         case UNDEF_GATE: g = new (_mem) CirUndefGate(id);        break;
+         default: break;
+      }
+      if (!g || r._name > h._nameBytes)
+         return snapError(fileName, "has an illegal gate record");
+      if (r._name) {
+         const char* name = names + r._name - 1;
+         g->_name = _mem.allocStr(name, name + strlen(name));
+      }
+      g->_foNum = r._foNum;
+      nEdges += r._foNum;
+      nOfType[r._type]++;
+      _Gatelist[id] = g;
+   }
+   if (!_Gatelist[0] || nEdges != h._nEdges)
+      return snapError(fileName, "is truncated or corrupted");
+
+   // fanins, fanouts and the lists may only name gates that exist
+   _fanoutPool.resize(nEdges);
+   CirGateV* edge = nEdges? &_fanoutPool[0]: 0;
+   for (unsigned id = 0; id < h._nSlots; id++) {
+      CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      for (unsigned j = 0; j < g->getFaninNum(); j++) {
+         unsigned lit = slot[id]._fanin[j];
+         if (!getGate(lit / 2))
+            return snapError(fileName, "has an illegal fanin");
+         g->_fanin[j] = CirGateV(_Gatelist[lit / 2], lit & 1);
+      }
+      g->_fanout = edge;
+      for (unsigned k = 0; k < g->_foNum; k++, edge++) {
+         if (!getGate(*foLit / 2))
+            return snapError(fileName, "has an illegal fanout");
+         *edge = CirGateV(_Gatelist[*foLit / 2], *foLit & 1);
+         ++foLit;
+      }
+   }
+   if (!snapList(inId, h._I, PI_GATE, _in) ||
+       !snapList(outId, h._O, PO_GATE, _out) ||
+       !snapList(aigId, h._A, AIG_GATE, _aig) ||
+       !snapList(dfsId, h._nDfs, TOT_GATE, _dfsList))
+      return snapError(fileName, "has an illegal gate list");
+   // _in, _out and _aig hold each gate of their type once
+   if (nOfType[PI_GATE] != I || nOfType[PO_GATE] != O ||
+       nOfType[AIG_GATE] != A)
+      return snapError(fileName, "has an illegal gate list");
+   ++_globalRef;
+   const GateList* lists[3] = { &_in, &_out, &_aig };
+   for (int l = 0; l < 3; l++)
+      for (size_t i = 0; i < lists[l]->size(); i++) {
+         CirGate* g = (*lists[l])[i];
+         if (g->_ref == _globalRef)
+            return snapError(fileName, "has an illegal gate list");
+         g->_ref = _globalRef;
+      }
+   if (!snapFanoutsMatch())
+      return snapError(fileName, "has fanouts that do not match the fanins");
+   if (!snapTopoOrder())
+      return snapError(fileName, "has an illegal DFS order");
+   levelise();
+   return true;
+}
+
+// Fill "list" with the gates of the "n" IDs at "ids", all of type "type"
+// unless it is TOT_GATE
+bool
+CirMgr::snapList(const unsigned* ids, unsigned n, GateType type,
+                 GateList& list) const
+{
+   list.resize(n);
+   for (unsigned i = 0; i < n; i++) {
+      CirGate* g = getGate(ids[i]);
+      if (!g || (type != TOT_GATE && g->_type != type)) return false;
+      list[i] = g;
+   }
+   return true;
+}
+
+// The fanouts of a gate must list each gate that has it as a fanin,
+// as many times as it does and with the same phase
+bool
+CirMgr::snapFanoutsMatch() const
+{
+   IdList nRefs(_Gatelist.size(), 0), nListed(_Gatelist.size(), 0);
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      const CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      for (unsigned j = 0; j < g->getFaninNum(); j++)
+         nRefs[g->_fanin[j]->_id]++;
+   }
+   for (size_t id = 0; id < _Gatelist.size(); id++) {
+      CirGate* g = _Gatelist[id];
+      if (!g) continue;
+      if (nRefs[id] != g->_foNum) return false;
+      for (unsigned k = 0; k < g->_foNum; k++) {
+         const CirGateV& out = g->_fanout[k];
+         CirGateV in(g, out.isInv());
+         unsigned j = 0;
+         while (j < out->getFaninNum() && out->_fanin[j] != in) ++j;
+         if (j == out->getFaninNum()) return false;
+         nListed[out->_id]++;
+      }
+      for (unsigned k = 0; k < g->_foNum; k++) {
+         const CirGate* out = g->_fanout[k].gate();
+         if (!nListed[out->_id]) continue;
+         unsigned n = 0;
+         for (unsigned j = 0; j < out->getFaninNum(); j++)
+            n += (out->_fanin[j].gate() == g);
+         if (nListed[out->_id] != n) return false;
+         nListed[out->_id] = 0;
+      }
+   }
+   return true;
+}
+
+// _dfsList must list each gate once and after all of its fanins, and must
+// include every PO, which makes it a topological order of all that the
+// POs reach; levelise() and the passes rely on that. Leave the gates of
+// the list marked with _globalRef, as DFS() does.
+bool
+CirMgr::snapTopoOrder()
+{
+   ++_globalRef;
+   for (size_t i = 0; i < _dfsList.size(); i++) {
+      CirGate* g = _dfsList[i];
+      if (g->_ref == _globalRef) return false;
+      for (unsigned j = 0; j < g->getFaninNum(); j++)
+         if (g->_fanin[j]->_ref != _globalRef) return false;
+      g->_ref = _globalRef;
+   }
+   for (size_t i = 0; i < _out.size(); i++)
+      if (_out[i]->_ref != _globalRef) return false;
+   return true;
+}
@@ -0,0 +1,528 @@
+/****************************************************************************
+  FileName     [ sat.cpp ]
+  PackageName  [ sat ]
+  Synopsis     [ Define the CDCL SAT solver for circuit proofs ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2010-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "sat.h"
+
+using namespace std;
+
+// Conflicts per unit of the Luby restart sequence
+#define SAT_RESTART_UNIT   100
+#define SAT_VAR_DECAY      0.95
+#define SAT_CLA_DECAY      0.999
+// Learnt clause limit: a third of the problem clauses at first, and this
+// many at least; it grows by SAT_LEARNT_GROW after SAT_ADJUST_FIRST
+// conflicts, then after 1.5 times as many each time
+#define SAT_MIN_LEARNTS    2000
+#define SAT_LEARNT_GROW    1.1
+#define SAT_ADJUST_FIRST   100
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+static size_t
+luby(size_t i)
+{
+   size_t size = 1, seq = 0;
+   while (size < i + 1) { size = 2 * size + 1; ++seq; }
+   while (size - 1 != i) {
+      size = (size - 1) >> 1;
+      --seq;
+      i %= size;
+   }
+   return size_t(1) << seq;
+}
+
+struct LearntLess
+{
+   LearntLess(const vector<float>& act): _act(act) {}
+   bool operator() (size_t a, size_t b) const { return _act[a] < _act[b]; }
+   const vector<float>& _act;
+};
+
+/*******************************/
+/*   Public member functions   */
+/*******************************/
+void
+SatSolver::reset()
+{
+   _ok = true;
+   _mem.clear(); _wasted = 0;
+   _clauses.clear(); _learnts.clear(); _watches.clear();
+   _assigns.clear(); _model.clear(); _phase.clear(); _decision.clear();
+   _level.clear();
+   _reason.clear(); _activity.clear(); _seen.clear();
+   _trail.clear(); _trailLim.clear(); _qhead = 0; _assumps.clear();
+   _heap.clear(); _heapIdx.clear();
+   _varInc = 1; _claInc = 1; _maxLearnts = 0;
+   _learntAdjust = _learntAdjustInc = SAT_ADJUST_FIRST;
+   _nConflicts = _nDecisions = _nPropagations = 0;
+}
+
+Var
+SatSolver::newVar(bool decision)
+{
+   Var v = _assigns.size();
+   _watches.resize(2 * (v + 1));
+   _assigns.push_back(0);
+   _phase.push_back(false);
+   _decision.push_back(false);
+   _level.push_back(0);
+   _reason.push_back(CREF_NONE);
+   _activity.push_back(0);
+   _seen.push_back(0);
+   _heapIdx.push_back(-1);
+   setDecisionVar(v, decision);
+   return v;
+}
+
+void
+SatSolver::setDecisionVar(Var v, bool decision)
+{
+   _decision[v] = decision;
+   if (decision && _assigns[v] == 0 && _heapIdx[v] < 0) heapInsert(v);
+}
+
+// Only called at decision level 0
+bool
+SatSolver::addClause(const vector<Lit>& lits)
+{
+   assert(decisionLevel() == 0);
+   if (!_ok) return false;
+   vector<Lit> c(lits);
+   sort(c.begin(), c.end());
+   size_t n = 0;
+   for (size_t i = 0; i < c.size(); i++) {
+      if (litValue(c[i]) > 0 || (i && c[i] == litNeg(c[i-1])))
+         return true;   // satisfied or tautology
+      if (litValue(c[i]) < 0 || (i && c[i] == c[i-1])) continue;
+      c[n++] = c[i];
+   }
+   c.resize(n);
+   if (c.empty()) return _ok = false;
+   if (c.size() == 1) {
+      enqueue(c[0], CREF_NONE);
+      return _ok = (propagate() == CREF_NONE);
+   }
+   CRef cr = allocClause(c, false);
+   _clauses.push_back(cr);
+   attachClause(cr);
+   return true;
+}
+
+void
+SatSolver::addAigCNF(Var vf, Var va, bool fa, Var vb, bool fb)
+{
+   Lit f = mkLit(vf), a = mkLit(va, fa), b = mkLit(vb, fb);
+   vector<Lit> c(2);
+   c[0] = a; c[1] = litNeg(f); addClause(c);
+   c[0] = b; c[1] = litNeg(f); addClause(c);
+   c.push_back(f);
+   c[0] = litNeg(a); c[1] = litNeg(b); addClause(c);
+}
+
+void
+SatSolver::addXorCNF(Var vf, Var va, bool fa, Var vb, bool fb)
+{
+   Lit f = mkLit(vf), a = mkLit(va, fa), b = mkLit(vb, fb);
+   vector<Lit> c(3);
+   c[0] = a;         c[1] = b;         c[2] = litNeg(f); addClause(c);
+   c[0] = litNeg(a); c[1] = litNeg(b); c[2] = litNeg(f); addClause(c);
+   c[0] = a;         c[1] = litNeg(b); c[2] = f;         addClause(c);
+   c[0] = litNeg(a); c[1] = b;         c[2] = f;         addClause(c);
+}
+
+// The search is restarted after luby(i) * SAT_RESTART_UNIT conflicts;
+// decisions 1..n are the assumptions, so an assumption found false makes
+// the query UNSAT without touching the clauses
+SatResult
+SatSolver::assumpSolve(size_t budget)
+{
+   if (!_ok) return SAT_UNSAT;
+   _maxLearnts = max(_maxLearnts,
+                     max(double(_clauses.size()) / 3, double(SAT_MIN_LEARNTS)));
+   size_t confLimit = budget? _nConflicts + budget: 0;
+   SatResult r = SAT_UNDEF;
+   for (size_t i = 0; r == SAT_UNDEF; i++) {
+      if (confLimit && _nConflicts >= confLimit) break;
+      r = search(luby(i) * SAT_RESTART_UNIT, confLimit);
+   }
+   if (r == SAT_SAT) _model = _assigns;
+   cancelUntil(0);
+   return r;
+}
+
+/********************************/
+/*   Private member functions   */
+/********************************/
+float
+SatSolver::clauseActivity(CRef c) const
+{
+   float act;
+   memcpy(&act, &_mem[c + 1], sizeof(act));
+   return act;
+}
+
+void
+SatSolver::setClauseActivity(CRef c, float act)
+{
+   memcpy(&_mem[c + 1], &act, sizeof(act));
+}
+
+CRef
+SatSolver::allocClause(const vector<Lit>& lits, bool learnt)
+{
+   CRef c = _mem.size();
+   _mem.push_back(unsigned(lits.size()) << 2 | unsigned(learnt));
+   _mem.push_back(0);
+   _mem.insert(_mem.end(), lits.begin(), lits.end());
+   setClauseActivity(c, 0);
+   return c;
+}
+
+void
+SatSolver::attachClause(CRef c)
+{
+   const Lit* lits = clauseLits(c);
+   _watches[lits[0]].push_back(Watcher(c, lits[1]));
+   _watches[lits[1]].push_back(Watcher(c, lits[0]));
+}
+
+// A clause is locked while it is the reason of its first literal
+bool
+SatSolver::locked(CRef c)
+{
+   Lit p = clauseLits(c)[0];
+   return _reason[litVar(p)] == c && litValue(p) > 0;
+}
+
+// Delete the less active half of the learnt clauses, except binary and
+// locked ones; the watchers are purged in one sweep
+void
+SatSolver::reduceDB()
+{
+   vector<float> act(_learnts.size());
+   vector<size_t> order(_learnts.size());
+   for (size_t i = 0; i < _learnts.size(); i++) {
+      act[i] = clauseActivity(_learnts[i]);
+      order[i] = i;
+   }
+   sort(order.begin(), order.end(), LearntLess(act));
+   size_t nDel = 0;
+   for (size_t k = 0; k < order.size() && nDel < order.size() / 2; k++) {
+      CRef c = _learnts[order[k]];
+      if (clauseSize(c) <= 2 || locked(c)) continue;
+      _mem[c] |= 2;
+      _wasted += clauseSize(c) + 2;
+      ++nDel;
+   }
+   size_t n = 0;
+   for (size_t i = 0; i < _learnts.size(); i++)
+      if (!isDeleted(_learnts[i])) _learnts[n++] = _learnts[i];
+   _learnts.resize(n);
+   for (size_t p = 0; p < _watches.size(); p++) {
+      vector<Watcher>& ws = _watches[p];
+      size_t j = 0;
+      for (size_t i = 0; i < ws.size(); i++)
+         if (!isDeleted(ws[i]._cref)) ws[j++] = ws[i];
+      ws.resize(j);
+   }
+}
+
+// Compact the clause arena; only called at decision level 0, where no
+// reason is needed any more
+void
+SatSolver::garbageCollect()
+{
+   assert(decisionLevel() == 0);
+   for (size_t i = 0; i < _trail.size(); i++)
+      _reason[litVar(_trail[i])] = CREF_NONE;
+   vector<unsigned> mem;
+   mem.reserve(_mem.size() - _wasted);
+   vector<CRef>* lists[2] = { &_clauses, &_learnts };
+   for (unsigned l = 0; l < 2; l++) {
+      vector<CRef>& list = *lists[l];
+      for (size_t i = 0; i < list.size(); i++) {
+         CRef c = list[i];
+         list[i] = mem.size();
+         mem.insert(mem.end(), _mem.begin() + c,
+                    _mem.begin() + c + 2 + clauseSize(c));
+      }
+   }
+   _mem.swap(mem);
+   _wasted = 0;
+   for (size_t p = 0; p < _watches.size(); p++) _watches[p].clear();
+   for (size_t i = 0; i < _clauses.size(); i++) attachClause(_clauses[i]);
+   for (size_t i = 0; i < _learnts.size(); i++) attachClause(_learnts[i]);
+}
+
+void
+SatSolver::enqueue(Lit p, CRef from)
+{
+   Var v = litVar(p);
+   assert(_assigns[v] == 0);
+   _assigns[v] = litSign(p)? -1: 1;
+   _level[v] = decisionLevel();
+   _reason[v] = from;
+   _trail.push_back(p);
+   ++_nPropagations;
+}
+
+void
+SatSolver::cancelUntil(unsigned level)
+{
+   if (decisionLevel() <= level) return;
+   for (size_t i = _trail.size(); i > _trailLim[level]; i--) {
+      Var v = litVar(_trail[i-1]);
+      _phase[v] = _assigns[v] > 0;
+      _assigns[v] = 0;
+      _reason[v] = CREF_NONE;
+      if (_decision[v] && _heapIdx[v] < 0) heapInsert(v);
+   }
+   _trail.resize(_trailLim[level]);
+   _trailLim.resize(level);
+   _qhead = _trail.size();
+}
+
+// Unit propagation with two watched literals: the first two literals of a
+// clause are watched, and _watches[p] is visited when "p" becomes false.
+// Return the conflicting clause or CREF_NONE.
+CRef
+SatSolver::propagate()
+{
+   CRef confl = CREF_NONE;
+   while (_qhead < _trail.size()) {
+      Lit falseLit = litNeg(_trail[_qhead++]);
+      vector<Watcher>& ws = _watches[falseLit];
+      size_t i = 0, j = 0, n = ws.size();
+      while (i < n) {
+         if (litValue(ws[i]._blocker) > 0) { ws[j++] = ws[i++]; continue; }
+         CRef c = ws[i++]._cref;
+         Lit* lits = clauseLits(c);
+         if (lits[0] == falseLit) swap(lits[0], lits[1]);
+         Lit first = lits[0];
+         if (litValue(first) > 0) { ws[j++] = Watcher(c, first); continue; }
+         unsigned size = clauseSize(c), k = 2;
+         for (; k < size; k++)
+            if (litValue(lits[k]) >= 0) break;
+         if (k < size) {
+            lits[1] = lits[k];
+            lits[k] = falseLit;
+            _watches[lits[1]].push_back(Watcher(c, first));
+            continue;
+         }
+         ws[j++] = Watcher(c, first);
+         if (litValue(first) < 0) {
+            confl = c;
+            _qhead = _trail.size();
+            while (i < n) ws[j++] = ws[i++];
+         }
+         else enqueue(first, c);
+      }
+      ws.resize(j);
+   }
+   return confl;
+}
+
+// First-UIP conflict analysis; learnt[0] is the asserting literal and
+// learnt[1] has the highest level of the rest. A literal is dropped when
+// its reason is subsumed by the others.
+void
+SatSolver::analyze(CRef confl, vector<Lit>& learnt, unsigned& btLevel)
+{
+   learnt.assign(1, LIT_UNDEF);
+   int pathC = 0;
+   Lit p = LIT_UNDEF;
+   size_t index = _trail.size();
+   do {
+      if (isLearnt(confl)) bumpClause(confl);
+      const Lit* lits = clauseLits(confl);
+      for (unsigned k = (p == LIT_UNDEF)? 0: 1; k < clauseSize(confl); k++) {
+         Var v = litVar(lits[k]);
+         if (_seen[v] || _level[v] == 0) continue;
+         bumpVar(v);
+         _seen[v] = 1;
+         if (_level[v] >= decisionLevel()) ++pathC;
+         else learnt.push_back(lits[k]);
+      }
+      while (!_seen[litVar(_trail[--index])]);
+      p = _trail[index];
+      confl = _reason[litVar(p)];
+      _seen[litVar(p)] = 0;
+   } while (--pathC > 0);
+   learnt[0] = litNeg(p);
+
+   vector<Lit> toClear(learnt);
+   size_t n = 1;
+   for (size_t i = 1; i < learnt.size(); i++) {
+      CRef r = _reason[litVar(learnt[i])];
+      bool keep = (r == CREF_NONE);
+      if (!keep) {
+         const Lit* lits = clauseLits(r);
+         for (unsigned k = 1; k < clauseSize(r); k++) {
+            Var v = litVar(lits[k]);
+            if (!_seen[v] && _level[v] > 0) { keep = true; break; }
+         }
+      }
+      if (keep) learnt[n++] = learnt[i];
+   }
+   learnt.resize(n);
+
+   btLevel = 0;
+   if (learnt.size() > 1) {
+      size_t maxI = 1;
+      for (size_t i = 2; i < learnt.size(); i++)
+         if (_level[litVar(learnt[i])] > _level[litVar(learnt[maxI])]) maxI = i;
+      swap(learnt[1], learnt[maxI]);
+      btLevel = _level[litVar(learnt[1])];
+   }
+   for (size_t i = 0; i < toClear.size(); i++) _seen[litVar(toClear[i])] = 0;
+}
+
+Lit
+SatSolver::pickBranchLit()
+{
+   while (!_heap.empty()) {
+      Var v = heapPop();
+      if (_assigns[v] == 0 && _decision[v]) return mkLit(v, !_phase[v]);
+   }
+   return LIT_UNDEF;
+}
+
+// Search until a model, a proof, "nConflicts" conflicts in this call or
+// the total conflict count "confLimit" (0: no limit)
+SatResult
+SatSolver::search(size_t nConflicts, size_t confLimit)
+{
+   vector<Lit> learnt;
+   size_t conflictC = 0;
+   while (true) {
+      CRef confl = propagate();
+      if (confl != CREF_NONE) {
+         ++_nConflicts; ++conflictC;
+         if (decisionLevel() == 0) { _ok = false; return SAT_UNSAT; }
+         unsigned btLevel;
+         analyze(confl, learnt, btLevel);
+         cancelUntil(btLevel);
+         if (learnt.size() == 1) enqueue(learnt[0], CREF_NONE);
+         else {
+            CRef c = allocClause(learnt, true);
+            _learnts.push_back(c);
+            attachClause(c);
+            bumpClause(c);
+            enqueue(learnt[0], c);
+         }
+         _varInc /= SAT_VAR_DECAY;
+         _claInc /= SAT_CLA_DECAY;
+         if (_nConflicts >= _learntAdjust) {
+            _learntAdjustInc *= 1.5;
+            _learntAdjust = _nConflicts + size_t(_learntAdjustInc);
+            _maxLearnts *= SAT_LEARNT_GROW;
+         }
+         continue;
+      }
+      if (conflictC >= nConflicts || (confLimit && _nConflicts >= confLimit)) {
+         cancelUntil(0);
+         if (_wasted > _mem.size() / 2) garbageCollect();
+         return SAT_UNDEF;
+      }
+      if (_learnts.size() >= _maxLearnts + _trail.size()) reduceDB();
+
+      Lit next = LIT_UNDEF;
+      while (decisionLevel() < _assumps.size()) {
+         Lit p = _assumps[decisionLevel()];
+         if (litValue(p) > 0) _trailLim.push_back(_trail.size());
+         else if (litValue(p) < 0) return SAT_UNSAT;
+         else { next = p; break; }
+      }
+      if (next == LIT_UNDEF) {
+         next = pickBranchLit();
+         if (next == LIT_UNDEF) return SAT_SAT;
+         ++_nDecisions;
+      }
+      _trailLim.push_back(_trail.size());
+      enqueue(next, CREF_NONE);
+   }
+}
+
+void
+SatSolver::bumpVar(Var v)
+{
+   if ((_activity[v] += _varInc) > 1e100) {
+      for (size_t i = 0; i < _activity.size(); i++) _activity[i] *= 1e-100;
+      _varInc *= 1e-100;
+   }
+   if (_heapIdx[v] >= 0) heapUp(_heapIdx[v]);
+}
+
+void
+SatSolver::bumpClause(CRef c)
+{
+   float act = clauseActivity(c) + _claInc;
+   setClauseActivity(c, act);
+   if (act > 1e20) {
+      for (size_t i = 0; i < _learnts.size(); i++)
+         setClauseActivity(_learnts[i], clauseActivity(_learnts[i]) * 1e-20);
+      _claInc *= 1e-20;
+   }
+}
+
+void
+SatSolver::heapInsert(Var v)
+{
+   _heapIdx[v] = _heap.size();
+   _heap.push_back(v);
+   heapUp(_heapIdx[v]);
+}
+
+Var
+SatSolver::heapPop()
+{
+   Var v = _heap[0];
+   _heap[0] = _heap.back();
+   _heapIdx[_heap[0]] = 0;
+   _heapIdx[v] = -1;
+   _heap.pop_back();
+   if (_heap.size() > 1) heapDown(0);
+   return v;
+}
+
+void
+SatSolver::heapUp(int i)
+{
+   Var v = _heap[i];
+   while (i > 0) {
+      int parent = (i - 1) >> 1;
+      if (!heapLess(v, _heap[parent])) break;
+      _heap[i] = _heap[parent];
+      _heapIdx[_heap[i]] = i;
+      i = parent;
+   }
+   _heap[i] = v;
+   _heapIdx[v] = i;
+}
+
+void
+SatSolver::heapDown(int i)
+{
+   Var v = _heap[i];
+   int n = _heap.size();
+   while (2 * i + 1 < n) {
+      int child = 2 * i + 1;
+      if (child + 1 < n && heapLess(_heap[child + 1], _heap[child])) ++child;
+      if (!heapLess(_heap[child], v)) break;
+      _heap[i] = _heap[child];
+      _heapIdx[_heap[i]] = i;
+      i = child;
+   }
+   _heap[i] = v;
+   _heapIdx[v] = i;
+}
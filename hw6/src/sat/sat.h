@@ -0,0 +1,150 @@
+/****************************************************************************
+  FileName     [ sat.h ]
+  PackageName  [ sat ]
+  Synopsis     [ Define the CDCL SAT solver for circuit proofs ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2010-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef SAT_H
+#define SAT_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+typedef int      Var;
+typedef unsigned Lit;        // 2 * var + sign; sign 1 is the complement
+typedef unsigned CRef;       // offset of a clause in SatSolver::_mem
+
+#define LIT_UNDEF   unsigned(-1)
+#define CREF_NONE   unsigned(-1)
+
+inline Lit  mkLit(Var v, bool sign = false) { return 2 * v + sign; }
+inline Var  litVar(Lit p) { return p >> 1; }
+inline bool litSign(Lit p) { return p & 1; }
+inline Lit  litNeg(Lit p) { return p ^ 1; }
+
+enum SatResult
+{
+   SAT_UNSAT = 0,
+   SAT_SAT   = 1,
+   SAT_UNDEF = 2       // conflict budget exhausted
+};
+
+// Conflict-driven clause learning with two watched literals, 1UIP learning,
+// VSIDS decisions with phase saving, Luby restarts and activity-based
+// learnt clause deletion. Clauses can be added between calls to
+// assumpSolve(), so one instance answers many queries on the same clauses.
+class SatSolver
+{
+public:
+   SatSolver() { reset(); }
+
+   void reset();
+   // Only decision variables are branched on; a model assigns every
+   // decision variable but not necessarily the others
+   Var newVar(bool decision = true);
+   void setDecisionVar(Var v, bool decision);
+   size_t nVars() const { return _assigns.size(); }
+
+   // Return false if the clauses become unsatisfiable without assumptions
+   bool addClause(const vector<Lit>& lits);
+   // vf = (va ^ fa) & (vb ^ fb)
+   void addAigCNF(Var vf, Var va, bool fa, Var vb, bool fb);
+   // vf = (va ^ fa) ^ (vb ^ fb)
+   void addXorCNF(Var vf, Var va, bool fa, Var vb, bool fb);
+
+   void assumeRelease() { _assumps.clear(); }
+   void assumeProperty(Var v, bool val) { _assumps.push_back(mkLit(v, !val)); }
+   // Solve under the assumptions; give up after "budget" conflicts (0: none)
+   SatResult assumpSolve(size_t budget = 0);
+   // Value of "v" in the model of the last SAT_SAT result; 0 if unassigned
+   int getValue(Var v) const { return _model[v] > 0; }
+
+   size_t nConflicts() const { return _nConflicts; }
+   size_t nDecisions() const { return _nDecisions; }
+   size_t nPropagations() const { return _nPropagations; }
+   size_t nLearnts() const { return _learnts.size(); }
+
+private:
+   struct Watcher {
+      Watcher(): _cref(CREF_NONE), _blocker(LIT_UNDEF) {}
+      Watcher(CRef c, Lit b): _cref(c), _blocker(b) {}
+      CRef  _cref;
+      Lit   _blocker;   // a literal of the clause; skip it if this is true
+   };
+
+   bool                       _ok;        // false: UNSAT at level 0
+   // clause arena: [size << 2 | deleted << 1 | learnt] [activity] [lits]
+   vector<unsigned>           _mem;
+   size_t                     _wasted;    // words of deleted clauses
+   vector<CRef>               _clauses;
+   vector<CRef>               _learnts;
+   vector<vector<Watcher> >   _watches;   // literal -> clauses watching it
+
+   // per variable
+   vector<signed char>        _assigns;   // 1: true, -1: false, 0: unassigned
+   vector<signed char>        _model;
+   vector<bool>               _phase;     // saved polarity
+   vector<bool>               _decision;
+   vector<unsigned>           _level;
+   vector<CRef>               _reason;
+   vector<double>             _activity;
+   vector<char>               _seen;
+
+   vector<Lit>                _trail;
+   vector<size_t>             _trailLim;  // trail size at each decision
+   size_t                     _qhead;
+   vector<Lit>                _assumps;
+
+   // VSIDS order: binary max-heap of variables by _activity
+   vector<Var>                _heap;
+   vector<int>                _heapIdx;   // -1: not in the heap
+
+   double                     _varInc;
+   double                     _claInc;
+   double                     _maxLearnts;
+   size_t                     _learntAdjust;    // conflict count to grow at
+   double                     _learntAdjustInc;
+   size_t                     _nConflicts;
+   size_t                     _nDecisions;
+   size_t                     _nPropagations;
+
+   // clause arena
+   unsigned clauseSize(CRef c) const { return _mem[c] >> 2; }
+   bool isLearnt(CRef c) const { return _mem[c] & 1; }
+   bool isDeleted(CRef c) const { return _mem[c] & 2; }
+   Lit* clauseLits(CRef c) { return &_mem[c + 2]; }
+   float clauseActivity(CRef c) const;
+   void setClauseActivity(CRef c, float act);
+   CRef allocClause(const vector<Lit>& lits, bool learnt);
+   void attachClause(CRef c);
+   bool locked(CRef c);
+   void reduceDB();
+   void garbageCollect();
+
+   // assignment
+   int litValue(Lit p) const {
+      return litSign(p)? -_assigns[litVar(p)]: _assigns[litVar(p)];
+   }
+   unsigned decisionLevel() const { return _trailLim.size(); }
+   void enqueue(Lit p, CRef from);
+   void cancelUntil(unsigned level);
+   CRef propagate();
+   void analyze(CRef confl, vector<Lit>& learnt, unsigned& btLevel);
+   Lit pickBranchLit();
+   SatResult search(size_t nConflicts, size_t confLimit);
+
+   // VSIDS
+   void bumpVar(Var v);
+   void bumpClause(CRef c);
+   bool heapLess(Var a, Var b) const { return _activity[a] > _activity[b]; }
+   void heapInsert(Var v);
+   Var heapPop();
+   void heapUp(int i);
+   void heapDown(int i);
+};
+
+#endif // SAT_H
@@ -7,6 +7,7 @@
 ****************************************************************************/
 #include <sys/types.h>
 #include <dirent.h>
+#include <sys/time.h>
 #include <errno.h>
 #include <vector>
 #include <string>
@@ -14,6 +15,8 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdlib>
+#include <new>
 #include "rnGen.h"
 #include "myUsage.h"
 
@@ -26,6 +29,11 @@ using namespace std;
 RandomNumGen  rnGen(0);  // use random seed = 0
 MyUsage       myUsage;
 
+// Heap allocations made so far by the whole program; the global operator
+// new below counts them for getAllocCount() and getAllocBytes()
+static size_t allocCount = 0;
+static size_t allocBytes = 0;
+
 
 //----------------------------------------------------------------------
 //    Global functions in util
@@ -76,3 +84,51 @@ size_t getHashSize(size_t s) {
    return 7000003;
 }
 
+// Wall-clock time in seconds, for measuring the run time of a pass
+double getWallTime()
+{
+   timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Number of operator new calls, and the bytes they asked for, so far.
+// A pass takes the difference to report its own allocations.
+size_t getAllocCount()
+{
+   return allocCount;
+}
+
+size_t getAllocBytes()
+{
+   return allocBytes;
+}
+
+//----------------------------------------------------------------------
+//    Counting global operator new/delete
+//----------------------------------------------------------------------
+// The counters are shared by the worker threads of the cir passes, hence
+// the atomic adds
+void* operator new(size_t n)
+{
+   __sync_fetch_and_add(&allocCount, 1);
+   __sync_fetch_and_add(&allocBytes, n);
+   void* p = malloc(n? n: 1);
+   if (!p) throw bad_alloc();
+   return p;
+}
+
+void* operator new[](size_t n)
+{
+   return operator new(n);
+}
+
+void operator delete(void* p) noexcept
+{
+   free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+   free(p);
+}
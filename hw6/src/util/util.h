@@ -33,6 +33,9 @@ extern char myGetChar();
 // In util.cpp
 extern int listDir(vector<string>&, const string&, const string&);
 extern size_t getHashSize(size_t s);
+extern double getWallTime();
+extern size_t getAllocCount();
+extern size_t getAllocBytes();
 
 // Other utility template functions
 template<class T>